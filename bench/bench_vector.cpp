@@ -0,0 +1,379 @@
+/**
+ * @file bench_vector.cpp
+ * @author itsjustgalileo
+ * @brief Micro-benchmarks for the Vector API, compared against std::vector.
+ *
+ * Usage: bench_vector [max_elements] [case]
+ *
+ * Runs every case for element sizes of 4, 16, 64 and 256 bytes and for
+ * element counts 1e3, 1e4, ... up to max_elements (default 1e6, up to
+ * 1e8). Quadratic cases (random insert/erase) are capped at 1e5
+ * elements. Each line reports ns/op and the bytes requested from the
+ * allocator during the timed region.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include "../vector.h"
+
+namespace {
+
+    struct AllocStats {
+        std::size_t bytes;
+        std::size_t calls;
+    };
+
+    AllocStats g_vector_stats;
+    AllocStats g_std_stats;
+
+    void *counting_allocate(void *ctx, std::size_t size) {
+        AllocStats *stats = static_cast<AllocStats *>(ctx);
+        stats->bytes += size;
+        ++stats->calls;
+
+        return std::malloc(size);
+    }
+
+    void *counting_reallocate(void *ctx, void *ptr, std::size_t old_size, std::size_t new_size) {
+        AllocStats *stats = static_cast<AllocStats *>(ctx);
+        (void)old_size;
+        stats->bytes += new_size;
+        ++stats->calls;
+
+        return std::realloc(ptr, new_size);
+    }
+
+    void counting_deallocate(void *ctx, void *ptr, std::size_t size) {
+        (void)ctx;
+        (void)size;
+
+        std::free(ptr);
+    }
+
+    const VectorAllocator g_counting_allocator = {
+        counting_allocate,
+        counting_reallocate,
+        counting_deallocate,
+        &g_vector_stats
+    };
+
+    template <typename T>
+    struct CountingAllocator {
+        using value_type = T;
+
+        CountingAllocator() noexcept {}
+
+        template <typename U>
+        CountingAllocator(const CountingAllocator<U> &) noexcept {}
+
+        T *allocate(std::size_t n) {
+            g_std_stats.bytes += n * sizeof(T);
+            ++g_std_stats.calls;
+
+            void *ptr = std::malloc(n * sizeof(T));
+            if (nullptr == ptr) {
+                throw std::bad_alloc();
+            }
+
+            return static_cast<T *>(ptr);
+        }
+
+        void deallocate(T *ptr, std::size_t) noexcept {
+            std::free(ptr);
+        }
+
+        template <typename U>
+        bool operator==(const CountingAllocator<U> &) const noexcept { return true; }
+
+        template <typename U>
+        bool operator!=(const CountingAllocator<U> &) const noexcept { return false; }
+    };
+
+    template <std::size_t N>
+    struct Elem {
+        unsigned char bytes[N];
+    };
+
+    template <std::size_t N>
+    using StdVector = std::vector<Elem<N>, CountingAllocator<Elem<N>>>;
+
+    volatile std::size_t g_sink;
+
+    /* Deterministic xorshift so both implementations see the same positions. */
+    struct Rng {
+        std::uint64_t state;
+
+        explicit Rng(std::uint64_t seed) : state(seed) {}
+
+        std::size_t below(std::size_t n) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+
+            return static_cast<std::size_t>(state % n);
+        }
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    class Timer {
+    public:
+        Timer() : vector_before_(g_vector_stats), std_before_(g_std_stats), start_(Clock::now()) {}
+
+        void report(const char *name, const char *impl, std::size_t elem_size, std::size_t n, std::size_t ops) {
+            const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start_).count();
+            const AllocStats &after = impl[0] == 's' ? g_std_stats : g_vector_stats;
+            const AllocStats &before = impl[0] == 's' ? std_before_ : vector_before_;
+
+            std::printf("%-18s %-11s %4zu %10zu %12.2f %14zu %8zu\n",
+                        name, impl, elem_size, n, ns / static_cast<double>(ops ? ops : 1),
+                        after.bytes - before.bytes, after.calls - before.calls);
+        }
+
+    private:
+        AllocStats vector_before_;
+        AllocStats std_before_;
+        Clock::time_point start_;
+    };
+
+    bool selected(const char *filter, const char *name) {
+        return nullptr == filter || std::strcmp(filter, name) == 0;
+    }
+
+    template <std::size_t N>
+    void bench_push_back(std::size_t n, bool reserve) {
+        const char *name = reserve ? "push_back_reserve" : "push_back";
+        Elem<N> elem;
+        std::memset(&elem, 1, sizeof(elem));
+
+        {
+            Timer timer;
+            Vector *vec = vector_create_with_allocator(0, N, nullptr, &g_counting_allocator);
+            if (reserve) {
+                vector_reserve(vec, n);
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                vector_push_back(vec, &elem);
+            }
+            g_sink = vector_size(vec);
+            timer.report(name, "vector", N, n, n);
+            vector_destroy(vec);
+        }
+
+        {
+            Timer timer;
+            StdVector<N> vec;
+            if (reserve) {
+                vec.reserve(n);
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                vec.push_back(elem);
+            }
+            g_sink = vec.size();
+            timer.report(name, "std::vector", N, n, n);
+        }
+    }
+
+    template <std::size_t N>
+    Vector *make_vector(std::size_t n) {
+        Vector *vec = vector_create_with_allocator(n, N, nullptr, &g_counting_allocator);
+        Elem<N> elem;
+        for (std::size_t i = 0; i < n; ++i) {
+            std::memset(&elem, static_cast<int>(i), sizeof(elem));
+            vector_push_back(vec, &elem);
+        }
+
+        return vec;
+    }
+
+    template <std::size_t N>
+    StdVector<N> make_std_vector(std::size_t n) {
+        StdVector<N> vec;
+        vec.reserve(n);
+        Elem<N> elem;
+        for (std::size_t i = 0; i < n; ++i) {
+            std::memset(&elem, static_cast<int>(i), sizeof(elem));
+            vec.push_back(elem);
+        }
+
+        return vec;
+    }
+
+    template <std::size_t N>
+    void bench_insert(std::size_t n) {
+        const std::size_t ops = n < 1000 ? n : 1000;
+        Elem<N> elem;
+        std::memset(&elem, 2, sizeof(elem));
+
+        {
+            Vector *vec = make_vector<N>(n);
+            Rng rng(42);
+            Timer timer;
+            for (std::size_t i = 0; i < ops; ++i) {
+                vector_insert(vec, rng.below(vector_size(vec) + 1), &elem);
+            }
+            timer.report("insert_random", "vector", N, n, ops);
+            vector_destroy(vec);
+        }
+
+        {
+            StdVector<N> vec = make_std_vector<N>(n);
+            Rng rng(42);
+            Timer timer;
+            for (std::size_t i = 0; i < ops; ++i) {
+                vec.insert(vec.begin() + static_cast<std::ptrdiff_t>(rng.below(vec.size() + 1)), elem);
+            }
+            timer.report("insert_random", "std::vector", N, n, ops);
+        }
+    }
+
+    template <std::size_t N>
+    void bench_erase(std::size_t n) {
+        const std::size_t ops = n < 1000 ? n : 1000;
+
+        {
+            Vector *vec = make_vector<N>(n);
+            Rng rng(42);
+            Timer timer;
+            for (std::size_t i = 0; i < ops; ++i) {
+                vector_erase(vec, rng.below(vector_size(vec)));
+            }
+            timer.report("erase_random", "vector", N, n, ops);
+            vector_destroy(vec);
+        }
+
+        {
+            StdVector<N> vec = make_std_vector<N>(n);
+            Rng rng(42);
+            Timer timer;
+            for (std::size_t i = 0; i < ops; ++i) {
+                vec.erase(vec.begin() + static_cast<std::ptrdiff_t>(rng.below(vec.size())));
+            }
+            timer.report("erase_random", "std::vector", N, n, ops);
+        }
+    }
+
+    template <std::size_t N>
+    void bench_foreach(std::size_t n) {
+        {
+            Vector *vec = make_vector<N>(n);
+            Timer timer;
+            std::size_t sum = 0;
+            vector_foreach(Elem<N>, it, vec) {
+                sum += it->bytes[0];
+            }
+            g_sink = sum;
+            timer.report("foreach", "vector", N, n, n);
+            vector_destroy(vec);
+        }
+
+        {
+            StdVector<N> vec = make_std_vector<N>(n);
+            Timer timer;
+            std::size_t sum = 0;
+            for (const Elem<N> &elem : vec) {
+                sum += elem.bytes[0];
+            }
+            g_sink = sum;
+            timer.report("foreach", "std::vector", N, n, n);
+        }
+    }
+
+    template <std::size_t N>
+    void bench_clone(std::size_t n) {
+        {
+            Vector *vec = make_vector<N>(n);
+            Timer timer;
+            Vector *clone = vector_clone(vec);
+            g_sink = vector_size(clone);
+            timer.report("clone", "vector", N, n, n);
+            vector_destroy(clone);
+            vector_destroy(vec);
+        }
+
+        {
+            StdVector<N> vec = make_std_vector<N>(n);
+            Timer timer;
+            StdVector<N> clone(vec);
+            g_sink = clone.size();
+            timer.report("clone", "std::vector", N, n, n);
+        }
+    }
+
+    template <std::size_t N>
+    void bench_shrink_to_fit(std::size_t n) {
+        {
+            Vector *vec = make_vector<N>(n);
+            vector_reserve(vec, n * 2);
+            Timer timer;
+            vector_shrink_to_fit(vec);
+            g_sink = vector_capacity(vec);
+            timer.report("shrink_to_fit", "vector", N, n, n);
+            vector_destroy(vec);
+        }
+
+        {
+            StdVector<N> vec = make_std_vector<N>(n);
+            vec.reserve(n * 2);
+            Timer timer;
+            vec.shrink_to_fit();
+            g_sink = vec.capacity();
+            timer.report("shrink_to_fit", "std::vector", N, n, n);
+        }
+    }
+
+    template <std::size_t N>
+    void bench_elem_size(std::size_t max_n, const char *filter) {
+        for (std::size_t n = 1000; n <= max_n; n *= 10) {
+            if (selected(filter, "push_back")) {
+                bench_push_back<N>(n, false);
+            }
+            if (selected(filter, "push_back_reserve")) {
+                bench_push_back<N>(n, true);
+            }
+            if (n <= 100000 && selected(filter, "insert_random")) {
+                bench_insert<N>(n);
+            }
+            if (n <= 100000 && selected(filter, "erase_random")) {
+                bench_erase<N>(n);
+            }
+            if (selected(filter, "foreach")) {
+                bench_foreach<N>(n);
+            }
+            if (selected(filter, "clone")) {
+                bench_clone<N>(n);
+            }
+            if (selected(filter, "shrink_to_fit")) {
+                bench_shrink_to_fit<N>(n);
+            }
+        }
+    }
+
+} /* namespace */
+
+int main(int argc, char **argv) {
+    std::size_t max_n = 1000000;
+    const char *filter = nullptr;
+
+    if (argc > 1) {
+        max_n = static_cast<std::size_t>(std::strtod(argv[1], nullptr));
+    }
+    if (argc > 2) {
+        filter = argv[2];
+    }
+
+    std::printf("%-18s %-11s %4s %10s %12s %14s %8s\n",
+                "case", "impl", "size", "n", "ns/op", "bytes_alloc", "allocs");
+
+    bench_elem_size<4>(max_n, filter);
+    bench_elem_size<16>(max_n, filter);
+    bench_elem_size<64>(max_n, filter);
+    bench_elem_size<256>(max_n, filter);
+
+    return 0;
+}
@@ -0,0 +1,685 @@
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bit_vector.h"
+#include "vector_internal.h"
+
+#define BIT_VECTOR_WORD_BITS 64
+#define BIT_VECTOR_BLOCK_WORDS 8
+
+/*
+ * Both vectors keep every storage bit past the last element zero,
+ * so words can be counted and combined without masking and reused
+ * by later growth as they are.
+ */
+struct BitVector {
+    uint64_t *words;                    /**< Bit storage. */
+    size_t bit_count;                   /**< Number of stored bits. */
+    size_t capacity;                    /**< Allocated words. */
+    size_t *ranks;                      /**< Set bits before each block of 8 words, or NULL. */
+    size_t n_ranks;                     /**< Entries in ranks. */
+    bool ranks_valid;                   /**< Whether ranks matches the words. */
+    const VectorAllocator *allocator;   /**< Allocator for header and storage. */
+};
+
+struct PackedVector {
+    uint64_t *words;                    /**< Element storage. */
+    size_t elem_count;                  /**< Number of stored elements. */
+    size_t capacity;                    /**< Allocated words. */
+    unsigned bits;                      /**< Width of one element. */
+    uint64_t mask;                      /**< Low bits mask of the element width. */
+    const VectorAllocator *allocator;   /**< Allocator for header and storage. */
+};
+
+static unsigned bit_vector_popcount(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ull);
+    word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+    word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0full;
+
+    return (unsigned)((word * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+static unsigned bit_vector_ctz(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(word);
+#else
+    unsigned idx = 0;
+    while (!(word & 1u)) {
+        word >>= 1;
+        ++idx;
+    }
+    return idx;
+#endif
+}
+
+/* Position of the k-th set bit of word, which has more than k set bits. */
+static unsigned bit_vector_select_word(uint64_t word, unsigned k) {
+    while (k-- > 0) {
+        word &= word - 1;
+    }
+
+    return bit_vector_ctz(word);
+}
+
+static size_t bit_vector_word_count(const size_t bits) {
+    return bits / BIT_VECTOR_WORD_BITS + (bits % BIT_VECTOR_WORD_BITS != 0);
+}
+
+/* Resize a word buffer to exactly capacity words, zero-filling any new words. */
+static bool bit_words_resize(const VectorAllocator *allocator,
+                             uint64_t **words,
+                             size_t *capacity,
+                             const size_t new_capacity) {
+    if (new_capacity > SIZE_MAX / sizeof(uint64_t)) {
+        return false;
+    }
+
+    if (new_capacity == 0) {
+        vector_mem_free(allocator, *words, *capacity * sizeof(uint64_t));
+        *words = NULL;
+        *capacity = 0;
+        return true;
+    }
+
+    uint64_t *fresh = NULL;
+    if (*words && allocator->reallocate) {
+        fresh = (uint64_t *)allocator->reallocate(allocator->ctx,
+                                                  *words,
+                                                  *capacity * sizeof(uint64_t),
+                                                  new_capacity * sizeof(uint64_t));
+        if (NULL == fresh) {
+            return false;
+        }
+    } else {
+        fresh = (uint64_t *)vector_mem_alloc(allocator, new_capacity * sizeof(uint64_t));
+        if (NULL == fresh) {
+            return false;
+        }
+
+        if (*words) {
+            memcpy(fresh, *words, (*capacity < new_capacity ? *capacity : new_capacity) * sizeof(uint64_t));
+            vector_mem_free(allocator, *words, *capacity * sizeof(uint64_t));
+        }
+    }
+
+    if (new_capacity > *capacity) {
+        memset(fresh + *capacity, 0, (new_capacity - *capacity) * sizeof(uint64_t));
+    }
+
+    *words = fresh;
+    *capacity = new_capacity;
+
+    return true;
+}
+
+/* Grow a word buffer geometrically to hold at least needed words. */
+static bool bit_words_reserve(const VectorAllocator *allocator,
+                              uint64_t **words,
+                              size_t *capacity,
+                              const size_t needed) {
+    if (needed <= *capacity) {
+        return true;
+    }
+
+    size_t new_capacity = *capacity > SIZE_MAX / 2 ? SIZE_MAX : *capacity * 2;
+    if (new_capacity < needed) {
+        new_capacity = needed;
+    }
+
+    return bit_words_resize(allocator, words, capacity, new_capacity);
+}
+
+BitVector *bit_vector_create(const size_t capacity) {
+    return bit_vector_create_with_allocator(capacity, NULL);
+}
+
+BitVector *bit_vector_create_with_allocator(const size_t capacity, const VectorAllocator *allocator) {
+    assert(allocator == NULL || allocator->allocate);
+
+    const VectorAllocator *used = vector_allocator_or_default(allocator);
+
+    BitVector *vec = (BitVector *)vector_mem_alloc(used, sizeof(BitVector));
+    if (NULL == vec) {
+        return NULL;
+    }
+
+    memset(vec, 0, sizeof(*vec));
+    vec->allocator = used;
+
+    if (!bit_words_resize(used, &vec->words, &vec->capacity, bit_vector_word_count(capacity))) {
+        vector_mem_free(used, vec, sizeof(BitVector));
+        return NULL;
+    }
+
+    return vec;
+}
+
+void bit_vector_destroy(BitVector *vec) {
+    assert(vec);
+
+    vector_mem_free(vec->allocator, vec->words, vec->capacity * sizeof(uint64_t));
+    vector_mem_free(vec->allocator, vec->ranks, vec->n_ranks * sizeof(size_t));
+    vector_mem_free(vec->allocator, vec, sizeof(BitVector));
+
+    return;
+}
+
+void bit_vector_clear(BitVector *vec) {
+    assert(vec);
+
+    bit_vector_resize(vec, 0, false);
+
+    return;
+}
+
+bool bit_vector_reserve(BitVector *vec, const size_t capacity) {
+    assert(vec);
+
+    const size_t needed = bit_vector_word_count(capacity);
+    if (needed <= vec->capacity) {
+        return true;
+    }
+
+    return bit_words_resize(vec->allocator, &vec->words, &vec->capacity, needed);
+}
+
+bool bit_vector_shrink_to_fit(BitVector *vec) {
+    assert(vec);
+
+    return bit_words_resize(vec->allocator, &vec->words, &vec->capacity, bit_vector_word_count(vec->bit_count));
+}
+
+bool bit_vector_resize(BitVector *vec, const size_t count, const bool value) {
+    assert(vec);
+
+    const size_t old_count = vec->bit_count;
+    const size_t old_words = bit_vector_word_count(old_count);
+    const size_t new_words = bit_vector_word_count(count);
+
+    if (count > old_count) {
+        if (!bit_words_reserve(vec->allocator, &vec->words, &vec->capacity, new_words)) {
+            return false;
+        }
+
+        if (value) {
+            if (old_count % BIT_VECTOR_WORD_BITS) {
+                vec->words[old_words - 1] |= ~0ull << (old_count % BIT_VECTOR_WORD_BITS);
+            }
+
+            memset(vec->words + old_words, 0xff, (new_words - old_words) * sizeof(uint64_t));
+        }
+    } else if (old_words > new_words) {
+        memset(vec->words + new_words, 0, (old_words - new_words) * sizeof(uint64_t));
+    }
+
+    if (count % BIT_VECTOR_WORD_BITS) {
+        vec->words[new_words - 1] &= ~(~0ull << (count % BIT_VECTOR_WORD_BITS));
+    }
+
+    vec->bit_count = count;
+    vec->ranks_valid = false;
+
+    return true;
+}
+
+bool bit_vector_push_back(BitVector *vec, const bool value) {
+    assert(vec);
+
+    const size_t idx = vec->bit_count;
+    if (idx == SIZE_MAX) {
+        return false;
+    }
+
+    if (!bit_words_reserve(vec->allocator, &vec->words, &vec->capacity, idx / BIT_VECTOR_WORD_BITS + 1)) {
+        return false;
+    }
+
+    vec->words[idx / BIT_VECTOR_WORD_BITS] |= (uint64_t)value << (idx % BIT_VECTOR_WORD_BITS);
+    vec->bit_count = idx + 1;
+    vec->ranks_valid = false;
+
+    return true;
+}
+
+bool bit_vector_pop_back(BitVector *vec) {
+    assert(vec && vec->bit_count);
+
+    const size_t idx = --vec->bit_count;
+    uint64_t *word = &vec->words[idx / BIT_VECTOR_WORD_BITS];
+    const uint64_t bit = 1ull << (idx % BIT_VECTOR_WORD_BITS);
+    const bool value = (*word & bit) != 0;
+
+    *word &= ~bit;
+    vec->ranks_valid = false;
+
+    return value;
+}
+
+bool bit_vector_get(const BitVector *vec, const size_t idx) {
+    assert(vec && idx < vec->bit_count);
+
+    return (vec->words[idx / BIT_VECTOR_WORD_BITS] >> (idx % BIT_VECTOR_WORD_BITS)) & 1u;
+}
+
+void bit_vector_set(BitVector *vec, const size_t idx, const bool value) {
+    assert(vec && idx < vec->bit_count);
+
+    uint64_t *word = &vec->words[idx / BIT_VECTOR_WORD_BITS];
+    const uint64_t bit = 1ull << (idx % BIT_VECTOR_WORD_BITS);
+
+    *word = value ? (*word | bit) : (*word & ~bit);
+    vec->ranks_valid = false;
+
+    return;
+}
+
+size_t bit_vector_size(const BitVector *vec) {
+    assert(vec);
+
+    return vec->bit_count;
+}
+
+size_t bit_vector_capacity(const BitVector *vec) {
+    assert(vec);
+
+    return vec->capacity > SIZE_MAX / BIT_VECTOR_WORD_BITS ? SIZE_MAX : vec->capacity * BIT_VECTOR_WORD_BITS;
+}
+
+bool bit_vector_is_empty(const BitVector *vec) {
+    assert(vec);
+
+    return vec->bit_count == 0;
+}
+
+const uint64_t *bit_vector_data(const BitVector *vec) {
+    assert(vec);
+
+    return vec->words;
+}
+
+static size_t bit_vector_count_words(const uint64_t *words, const size_t count) {
+    size_t total = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        total += bit_vector_popcount(words[i]);
+    }
+
+    return total;
+}
+
+size_t bit_vector_count(const BitVector *vec) {
+    assert(vec);
+
+    return bit_vector_count_words(vec->words, bit_vector_word_count(vec->bit_count));
+}
+
+bool bit_vector_build_index(BitVector *vec) {
+    assert(vec);
+
+    if (vec->ranks_valid) {
+        return true;
+    }
+
+    const size_t n_words = bit_vector_word_count(vec->bit_count);
+    const size_t n_ranks = n_words / BIT_VECTOR_BLOCK_WORDS + 1;
+
+    if (n_ranks != vec->n_ranks) {
+        size_t *ranks = (size_t *)vector_mem_alloc(vec->allocator, n_ranks * sizeof(size_t));
+        if (NULL == ranks) {
+            return false;
+        }
+
+        vector_mem_free(vec->allocator, vec->ranks, vec->n_ranks * sizeof(size_t));
+        vec->ranks = ranks;
+        vec->n_ranks = n_ranks;
+    }
+
+    size_t total = 0;
+    for (size_t block = 0; block < n_ranks; ++block) {
+        vec->ranks[block] = total;
+
+        const size_t first = block * BIT_VECTOR_BLOCK_WORDS;
+        if (first < n_words) {
+            const size_t count = n_words - first < BIT_VECTOR_BLOCK_WORDS ? n_words - first : BIT_VECTOR_BLOCK_WORDS;
+            total += bit_vector_count_words(vec->words + first, count);
+        }
+    }
+
+    vec->ranks_valid = true;
+
+    return true;
+}
+
+size_t bit_vector_rank(const BitVector *vec, const size_t idx) {
+    assert(vec && idx <= vec->bit_count);
+
+    const size_t word = idx / BIT_VECTOR_WORD_BITS;
+    size_t first = 0;
+    size_t total = 0;
+
+    if (vec->ranks_valid) {
+        first = word / BIT_VECTOR_BLOCK_WORDS * BIT_VECTOR_BLOCK_WORDS;
+        total = vec->ranks[word / BIT_VECTOR_BLOCK_WORDS];
+    }
+
+    total += bit_vector_count_words(vec->words + first, word - first);
+
+    if (idx % BIT_VECTOR_WORD_BITS) {
+        total += bit_vector_popcount(vec->words[word] & ~(~0ull << (idx % BIT_VECTOR_WORD_BITS)));
+    }
+
+    return total;
+}
+
+size_t bit_vector_select(const BitVector *vec, size_t k) {
+    assert(vec);
+
+    const size_t n_words = bit_vector_word_count(vec->bit_count);
+    size_t word = 0;
+
+    if (vec->ranks_valid) {
+        /* Last block whose running count is <= k. */
+        size_t lo = 0;
+        size_t hi = vec->n_ranks;
+        while (hi - lo > 1) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (vec->ranks[mid] <= k) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+
+        k -= vec->ranks[lo];
+        word = lo * BIT_VECTOR_BLOCK_WORDS;
+    }
+
+    for (; word < n_words; ++word) {
+        const unsigned count = bit_vector_popcount(vec->words[word]);
+        if (k < count) {
+            return word * BIT_VECTOR_WORD_BITS + bit_vector_select_word(vec->words[word], (unsigned)k);
+        }
+
+        k -= count;
+    }
+
+    return vec->bit_count;
+}
+
+bool bit_vector_and(BitVector *dst, const BitVector *src) {
+    assert(dst && src);
+
+    if (dst->bit_count != src->bit_count) {
+        return false;
+    }
+
+    const size_t n_words = bit_vector_word_count(dst->bit_count);
+    for (size_t i = 0; i < n_words; ++i) {
+        dst->words[i] &= src->words[i];
+    }
+
+    dst->ranks_valid = false;
+
+    return true;
+}
+
+bool bit_vector_or(BitVector *dst, const BitVector *src) {
+    assert(dst && src);
+
+    if (dst->bit_count != src->bit_count) {
+        return false;
+    }
+
+    const size_t n_words = bit_vector_word_count(dst->bit_count);
+    for (size_t i = 0; i < n_words; ++i) {
+        dst->words[i] |= src->words[i];
+    }
+
+    dst->ranks_valid = false;
+
+    return true;
+}
+
+bool bit_vector_xor(BitVector *dst, const BitVector *src) {
+    assert(dst && src);
+
+    if (dst->bit_count != src->bit_count) {
+        return false;
+    }
+
+    const size_t n_words = bit_vector_word_count(dst->bit_count);
+    for (size_t i = 0; i < n_words; ++i) {
+        dst->words[i] ^= src->words[i];
+    }
+
+    dst->ranks_valid = false;
+
+    return true;
+}
+
+void bit_vector_not(BitVector *vec) {
+    assert(vec);
+
+    const size_t n_words = bit_vector_word_count(vec->bit_count);
+    for (size_t i = 0; i < n_words; ++i) {
+        vec->words[i] = ~vec->words[i];
+    }
+
+    if (vec->bit_count % BIT_VECTOR_WORD_BITS) {
+        vec->words[n_words - 1] &= ~(~0ull << (vec->bit_count % BIT_VECTOR_WORD_BITS));
+    }
+
+    vec->ranks_valid = false;
+
+    return;
+}
+
+/* Words needed for count elements, or SIZE_MAX if the bit count overflows. */
+static size_t packed_vector_word_count(const PackedVector *vec, const size_t count) {
+    if (count > SIZE_MAX / vec->bits) {
+        return SIZE_MAX;
+    }
+
+    return bit_vector_word_count(count * vec->bits);
+}
+
+static void packed_vector_store(PackedVector *vec, const size_t idx, uint64_t value) {
+    const size_t pos = idx * vec->bits;
+    const size_t word = pos / BIT_VECTOR_WORD_BITS;
+    const unsigned shift = (unsigned)(pos % BIT_VECTOR_WORD_BITS);
+
+    value &= vec->mask;
+
+    vec->words[word] = (vec->words[word] & ~(vec->mask << shift)) | (value << shift);
+
+    if (shift + vec->bits > BIT_VECTOR_WORD_BITS) {
+        const unsigned spill = BIT_VECTOR_WORD_BITS - shift;
+        vec->words[word + 1] = (vec->words[word + 1] & ~(vec->mask >> spill)) | (value >> spill);
+    }
+
+    return;
+}
+
+PackedVector *packed_vector_create(const unsigned bits, const size_t capacity) {
+    return packed_vector_create_with_allocator(bits, capacity, NULL);
+}
+
+PackedVector *packed_vector_create_with_allocator(const unsigned bits,
+                                                  const size_t capacity,
+                                                  const VectorAllocator *allocator) {
+    assert(bits >= 1 && bits <= BIT_VECTOR_WORD_BITS);
+    assert(allocator == NULL || allocator->allocate);
+
+    const VectorAllocator *used = vector_allocator_or_default(allocator);
+
+    PackedVector *vec = (PackedVector *)vector_mem_alloc(used, sizeof(PackedVector));
+    if (NULL == vec) {
+        return NULL;
+    }
+
+    memset(vec, 0, sizeof(*vec));
+    vec->bits = bits;
+    vec->mask = bits == BIT_VECTOR_WORD_BITS ? ~0ull : (1ull << bits) - 1;
+    vec->allocator = used;
+
+    if (!bit_words_resize(used, &vec->words, &vec->capacity, packed_vector_word_count(vec, capacity))) {
+        vector_mem_free(used, vec, sizeof(PackedVector));
+        return NULL;
+    }
+
+    return vec;
+}
+
+void packed_vector_destroy(PackedVector *vec) {
+    assert(vec);
+
+    vector_mem_free(vec->allocator, vec->words, vec->capacity * sizeof(uint64_t));
+    vector_mem_free(vec->allocator, vec, sizeof(PackedVector));
+
+    return;
+}
+
+void packed_vector_clear(PackedVector *vec) {
+    assert(vec);
+
+    packed_vector_resize(vec, 0);
+
+    return;
+}
+
+bool packed_vector_reserve(PackedVector *vec, const size_t capacity) {
+    assert(vec);
+
+    const size_t needed = packed_vector_word_count(vec, capacity);
+    if (needed <= vec->capacity) {
+        return true;
+    }
+
+    return bit_words_resize(vec->allocator, &vec->words, &vec->capacity, needed);
+}
+
+bool packed_vector_shrink_to_fit(PackedVector *vec) {
+    assert(vec);
+
+    return bit_words_resize(vec->allocator, &vec->words, &vec->capacity, packed_vector_word_count(vec, vec->elem_count));
+}
+
+bool packed_vector_resize(PackedVector *vec, const size_t count) {
+    assert(vec);
+
+    if (count > vec->elem_count) {
+        if (!bit_words_reserve(vec->allocator, &vec->words, &vec->capacity, packed_vector_word_count(vec, count))) {
+            return false;
+        }
+    } else {
+        const size_t pos = count * vec->bits;
+        const size_t new_words = bit_vector_word_count(pos);
+        const size_t old_words = packed_vector_word_count(vec, vec->elem_count);
+
+        if (old_words > new_words) {
+            memset(vec->words + new_words, 0, (old_words - new_words) * sizeof(uint64_t));
+        }
+
+        if (pos % BIT_VECTOR_WORD_BITS) {
+            vec->words[new_words - 1] &= ~(~0ull << (pos % BIT_VECTOR_WORD_BITS));
+        }
+    }
+
+    vec->elem_count = count;
+
+    return true;
+}
+
+bool packed_vector_push_back(PackedVector *vec, const uint64_t value) {
+    assert(vec);
+
+    const size_t idx = vec->elem_count;
+    if (idx == SIZE_MAX) {
+        return false;
+    }
+
+    if (!bit_words_reserve(vec->allocator, &vec->words, &vec->capacity, packed_vector_word_count(vec, idx + 1))) {
+        return false;
+    }
+
+    packed_vector_store(vec, idx, value);
+    vec->elem_count = idx + 1;
+
+    return true;
+}
+
+uint64_t packed_vector_pop_back(PackedVector *vec) {
+    assert(vec && vec->elem_count);
+
+    const size_t idx = vec->elem_count - 1;
+    const uint64_t value = packed_vector_get(vec, idx);
+
+    packed_vector_store(vec, idx, 0);
+    vec->elem_count = idx;
+
+    return value;
+}
+
+uint64_t packed_vector_get(const PackedVector *vec, const size_t idx) {
+    assert(vec && idx < vec->elem_count);
+
+    const size_t pos = idx * vec->bits;
+    const size_t word = pos / BIT_VECTOR_WORD_BITS;
+    const unsigned shift = (unsigned)(pos % BIT_VECTOR_WORD_BITS);
+
+    uint64_t value = vec->words[word] >> shift;
+    if (shift + vec->bits > BIT_VECTOR_WORD_BITS) {
+        value |= vec->words[word + 1] << (BIT_VECTOR_WORD_BITS - shift);
+    }
+
+    return value & vec->mask;
+}
+
+void packed_vector_set(PackedVector *vec, const size_t idx, const uint64_t value) {
+    assert(vec && idx < vec->elem_count);
+
+    packed_vector_store(vec, idx, value);
+
+    return;
+}
+
+size_t packed_vector_size(const PackedVector *vec) {
+    assert(vec);
+
+    return vec->elem_count;
+}
+
+size_t packed_vector_capacity(const PackedVector *vec) {
+    assert(vec);
+
+    if (vec->capacity > SIZE_MAX / BIT_VECTOR_WORD_BITS) {
+        return SIZE_MAX / vec->bits;
+    }
+
+    return vec->capacity * BIT_VECTOR_WORD_BITS / vec->bits;
+}
+
+bool packed_vector_is_empty(const PackedVector *vec) {
+    assert(vec);
+
+    return vec->elem_count == 0;
+}
+
+unsigned packed_vector_bits(const PackedVector *vec) {
+    assert(vec);
+
+    return vec->bits;
+}
+
+const uint64_t *packed_vector_data(const PackedVector *vec) {
+    assert(vec);
+
+    return vec->words;
+}
@@ -0,0 +1,418 @@
+/**
+ * @file bit_vector.h
+ * @author itsjustgalileo
+ * @version 1.2
+ * @brief Bit-packed boolean and small-integer vectors.
+ */
+#ifndef BIT_VECTOR_H_
+#define BIT_VECTOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "vector.h"
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /**
+     * @brief Opaque vector of bits.
+     *
+     * Bits are packed 64 to a uint64_t word, bit i in word i / 64 at
+     * position i % 64. Storage bits past the last element are always
+     * zero, so whole words can be combined and counted directly.
+     */
+    typedef struct BitVector BitVector;
+
+    /**
+     * @brief Opaque vector of unsigned integers of a fixed bit width.
+     *
+     * Element i occupies bits [i * bits, (i + 1) * bits) of a stream
+     * of uint64_t words, least significant bit first; an element may
+     * straddle two words.
+     */
+    typedef struct PackedVector PackedVector;
+
+    /**
+     * @brief Create a new bit vector.
+     *
+     * @param capacity Initial capacity in bits.
+     *
+     * @return Pointer to a new BitVector, or NULL on allocation failure.
+     */
+    extern BitVector *bit_vector_create(size_t capacity);
+
+    /**
+     * @brief Create a new bit vector using a custom allocator.
+     *
+     * @param capacity  Initial capacity in bits.
+     * @param allocator Allocator to use, or NULL for malloc/free.
+     *
+     * @return Pointer to a new BitVector, or NULL on allocation failure.
+     */
+    extern BitVector *bit_vector_create_with_allocator(size_t capacity, const VectorAllocator *allocator);
+
+    /**
+     * @brief Destroy a bit vector and release all resources.
+     *
+     * @param vec Vector to destroy.
+     */
+    extern void bit_vector_destroy(BitVector *vec);
+
+    /**
+     * @brief Remove all bits. Capacity is kept.
+     *
+     * @param vec Vector to clear.
+     */
+    extern void bit_vector_clear(BitVector *vec);
+
+    /**
+     * @brief Ensure the vector can hold at least capacity bits.
+     *
+     * @param vec      Vector to reserve in.
+     * @param capacity Number of bits to make room for.
+     *
+     * @return true on success, false on allocation failure.
+     */
+    extern bool bit_vector_reserve(BitVector *vec, size_t capacity);
+
+    /**
+     * @brief Shrink capacity to the words needed for the current size.
+     *
+     * @param vec Vector to shrink.
+     *
+     * @return true on success, false on allocation failure.
+     */
+    extern bool bit_vector_shrink_to_fit(BitVector *vec);
+
+    /**
+     * @brief Change the number of bits.
+     *
+     * New bits are set to value.
+     *
+     * @param vec   Vector to resize.
+     * @param count New number of bits.
+     * @param value Value of any added bits.
+     *
+     * @return true on success, false on allocation failure.
+     */
+    extern bool bit_vector_resize(BitVector *vec, size_t count, bool value);
+
+    /**
+     * @brief Append a bit.
+     *
+     * @param vec   Vector to append to.
+     * @param value Bit to append.
+     *
+     * @return true on success, false on allocation failure.
+     */
+    extern bool bit_vector_push_back(BitVector *vec, bool value);
+
+    /**
+     * @brief Remove and return the last bit.
+     *
+     * @param vec Vector to pop from. Must not be empty.
+     *
+     * @return The removed bit.
+     */
+    extern bool bit_vector_pop_back(BitVector *vec);
+
+    /**
+     * @brief Get the bit at index.
+     *
+     * @param vec Vector to access.
+     * @param idx Index of the bit.
+     *
+     * @return The bit.
+     */
+    extern bool bit_vector_get(const BitVector *vec, size_t idx);
+
+    /**
+     * @brief Set the bit at index.
+     *
+     * @param vec   Vector to modify.
+     * @param idx   Index of the bit.
+     * @param value New value.
+     */
+    extern void bit_vector_set(BitVector *vec, size_t idx, bool value);
+
+    /**
+     * @brief Get the number of bits stored.
+     *
+     * @param vec Vector to query.
+     *
+     * @return Number of bits.
+     */
+    extern size_t bit_vector_size(const BitVector *vec);
+
+    /**
+     * @brief Get the number of bits the storage can hold.
+     *
+     * @param vec Vector to query.
+     *
+     * @return Capacity in bits.
+     */
+    extern size_t bit_vector_capacity(const BitVector *vec);
+
+    /**
+     * @brief Check whether the vector is empty.
+     *
+     * @param vec Vector to query.
+     *
+     * @return true if empty, false otherwise.
+     */
+    extern bool bit_vector_is_empty(const BitVector *vec);
+
+    /**
+     * @brief Get the underlying words.
+     *
+     * Holds (size + 63) / 64 words; bits past the size are zero.
+     *
+     * @param vec Vector to access.
+     *
+     * @return Pointer to the first word.
+     */
+    extern const uint64_t *bit_vector_data(const BitVector *vec);
+
+    /**
+     * @brief Count the set bits.
+     *
+     * @param vec Vector to query.
+     *
+     * @return Number of bits set to 1.
+     */
+    extern size_t bit_vector_count(const BitVector *vec);
+
+    /**
+     * @brief Build the rank directory used by bit_vector_rank and bit_vector_select.
+     *
+     * The directory holds one running count per 512 bits, which makes
+     * rank O(1) and select O(log n). Any modification of the vector
+     * drops it; without it both queries scan the words.
+     *
+     * @param vec Vector to index.
+     *
+     * @return true on success, false on allocation failure.
+     */
+    extern bool bit_vector_build_index(BitVector *vec);
+
+    /**
+     * @brief Count the set bits before an index.
+     *
+     * @param vec Vector to query.
+     * @param idx End of the counted range (0 <= idx <= size).
+     *
+     * @return Number of set bits in [0, idx).
+     */
+    extern size_t bit_vector_rank(const BitVector *vec, size_t idx);
+
+    /**
+     * @brief Find the k-th set bit.
+     *
+     * @param vec Vector to query.
+     * @param k   Zero-based rank of the set bit to find.
+     *
+     * @return Index of the set bit with rank k, or size if there are
+     *         not more than k set bits.
+     */
+    extern size_t bit_vector_select(const BitVector *vec, size_t k);
+
+    /**
+     * @brief dst &= src, one word at a time.
+     *
+     * @param dst Vector to modify.
+     * @param src Operand. Must have the same size as dst.
+     *
+     * @return true on success, false if the sizes differ.
+     */
+    extern bool bit_vector_and(BitVector *dst, const BitVector *src);
+
+    /**
+     * @brief dst |= src, one word at a time.
+     *
+     * @param dst Vector to modify.
+     * @param src Operand. Must have the same size as dst.
+     *
+     * @return true on success, false if the sizes differ.
+     */
+    extern bool bit_vector_or(BitVector *dst, const BitVector *src);
+
+    /**
+     * @brief dst ^= src, one word at a time.
+     *
+     * @param dst Vector to modify.
+     * @param src Operand. Must have the same size as dst.
+     *
+     * @return true on success, false if the sizes differ.
+     */
+    extern bool bit_vector_xor(BitVector *dst, const BitVector *src);
+
+    /**
+     * @brief Invert every bit.
+     *
+     * @param vec Vector to modify.
+     */
+    extern void bit_vector_not(BitVector *vec);
+
+    /**
+     * @brief Create a new packed integer vector.
+     *
+     * @param bits     Width of each element in bits (1 to 64).
+     * @param capacity Initial capacity in elements.
+     *
+     * @return Pointer to a new PackedVector, or NULL on allocation failure.
+     */
+    extern PackedVector *packed_vector_create(unsigned bits, size_t capacity);
+
+    /**
+     * @brief Create a new packed integer vector using a custom allocator.
+     *
+     * @param bits      Width of each element in bits (1 to 64).
+     * @param capacity  Initial capacity in elements.
+     * @param allocator Allocator to use, or NULL for malloc/free.
+     *
+     * @return Pointer to a new PackedVector, or NULL on allocation failure.
+     */
+    extern PackedVector *packed_vector_create_with_allocator(unsigned bits,
+                                                             size_t capacity,
+                                                             const VectorAllocator *allocator);
+
+    /**
+     * @brief Destroy a packed vector and release all resources.
+     *
+     * @param vec Vector to destroy.
+     */
+    extern void packed_vector_destroy(PackedVector *vec);
+
+    /**
+     * @brief Remove all elements. Capacity is kept.
+     *
+     * @param vec Vector to clear.
+     */
+    extern void packed_vector_clear(PackedVector *vec);
+
+    /**
+     * @brief Ensure the vector can hold at least capacity elements.
+     *
+     * @param vec      Vector to reserve in.
+     * @param capacity Number of elements to make room for.
+     *
+     * @return true on success, false on allocation failure.
+     */
+    extern bool packed_vector_reserve(PackedVector *vec, size_t capacity);
+
+    /**
+     * @brief Shrink capacity to the words needed for the current size.
+     *
+     * @param vec Vector to shrink.
+     *
+     * @return true on success, false on allocation failure.
+     */
+    extern bool packed_vector_shrink_to_fit(PackedVector *vec);
+
+    /**
+     * @brief Change the number of elements. Added elements are zero.
+     *
+     * @param vec   Vector to resize.
+     * @param count New number of elements.
+     *
+     * @return true on success, false on allocation failure.
+     */
+    extern bool packed_vector_resize(PackedVector *vec, size_t count);
+
+    /**
+     * @brief Append an element.
+     *
+     * Bits of value above the element width are dropped.
+     *
+     * @param vec   Vector to append to.
+     * @param value Value to append.
+     *
+     * @return true on success, false on allocation failure.
+     */
+    extern bool packed_vector_push_back(PackedVector *vec, uint64_t value);
+
+    /**
+     * @brief Remove and return the last element.
+     *
+     * @param vec Vector to pop from. Must not be empty.
+     *
+     * @return The removed value.
+     */
+    extern uint64_t packed_vector_pop_back(PackedVector *vec);
+
+    /**
+     * @brief Get the element at index.
+     *
+     * @param vec Vector to access.
+     * @param idx Index of the element.
+     *
+     * @return The element's value.
+     */
+    extern uint64_t packed_vector_get(const PackedVector *vec, size_t idx);
+
+    /**
+     * @brief Set the element at index.
+     *
+     * Bits of value above the element width are dropped.
+     *
+     * @param vec   Vector to modify.
+     * @param idx   Index of the element.
+     * @param value New value.
+     */
+    extern void packed_vector_set(PackedVector *vec, size_t idx, uint64_t value);
+
+    /**
+     * @brief Get the number of elements stored.
+     *
+     * @param vec Vector to query.
+     *
+     * @return Number of elements.
+     */
+    extern size_t packed_vector_size(const PackedVector *vec);
+
+    /**
+     * @brief Get the number of elements the storage can hold.
+     *
+     * @param vec Vector to query.
+     *
+     * @return Capacity in elements.
+     */
+    extern size_t packed_vector_capacity(const PackedVector *vec);
+
+    /**
+     * @brief Check whether the vector is empty.
+     *
+     * @param vec Vector to query.
+     *
+     * @return true if empty, false otherwise.
+     */
+    extern bool packed_vector_is_empty(const PackedVector *vec);
+
+    /**
+     * @brief Get the element width.
+     *
+     * @param vec Vector to query.
+     *
+     * @return Bits per element.
+     */
+    extern unsigned packed_vector_bits(const PackedVector *vec);
+
+    /**
+     * @brief Get the underlying words.
+     *
+     * @param vec Vector to access.
+     *
+     * @return Pointer to the first word.
+     */
+    extern const uint64_t *packed_vector_data(const PackedVector *vec);
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BIT_VECTOR_H_ */
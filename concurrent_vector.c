@@ -0,0 +1,256 @@
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "concurrent_vector.h"
+#include "vector_internal.h"
+
+#define CONCURRENT_VECTOR_MAX_SEGMENTS 64
+#define CONCURRENT_VECTOR_MIN_SEGMENT 8
+
+/* Segments are doubling blocks (see vector_block_locate). */
+struct ConcurrentVector {
+    size_t reserved;                    /**< Claimed slots, bumped with fetch_add. */
+    char pad[VECTOR_CACHE_LINE - sizeof(size_t)]; /**< Keeps the hot counter on its own line. */
+    void *segments[CONCURRENT_VECTOR_MAX_SEGMENTS]; /**< Segment storage, installed with CAS. */
+    size_t elem_size;                   /**< Size of one element in bytes. */
+    size_t base;                        /**< Elements in segment 0, a power of two. */
+    unsigned base_shift;                /**< log2(base). */
+    void (*destructor)(void *);         /**< Optional per-element destructor. */
+    const VectorAllocator *allocator;   /**< Allocator for header and segments. */
+    const VectorAllocator *user_allocator; /**< Allocator handed to frozen Vectors, or NULL. */
+};
+
+/*
+ * Installed in place of a segment whose allocation failed. Every slot
+ * of a segment is then either published (the segment exists) or lost
+ * (it never will), so teardown and freeze can tell them apart.
+ */
+static char concurrent_vector_failed;
+#define CONCURRENT_VECTOR_FAILED ((void *)&concurrent_vector_failed)
+
+static size_t concurrent_vector_segment_count(const ConcurrentVector *vec, const unsigned segment) {
+    return vector_block_size(vec->base, segment);
+}
+
+static size_t concurrent_vector_segment_start(const ConcurrentVector *vec, const unsigned segment) {
+    return vector_block_start(vec->base, segment);
+}
+
+/* Whether segment lies entirely within the addressable index and byte range. */
+static bool concurrent_vector_segment_fits(const ConcurrentVector *vec, const unsigned segment) {
+    if (segment + vec->base_shift >= sizeof(size_t) * 8) {
+        return false;
+    }
+
+    return concurrent_vector_segment_count(vec, segment) <= SIZE_MAX / vec->elem_size;
+}
+
+static void *concurrent_vector_segment(ConcurrentVector *vec, const unsigned segment) {
+    void *seg = vector_atomic_load_ptr(&vec->segments[segment]);
+    if (seg) {
+        return seg == CONCURRENT_VECTOR_FAILED ? NULL : seg;
+    }
+
+    if (!concurrent_vector_segment_fits(vec, segment)) {
+        return NULL;
+    }
+
+    const size_t size = concurrent_vector_segment_count(vec, segment) * vec->elem_size;
+    void *fresh = vector_mem_alloc(vec->allocator, size);
+    if (NULL == fresh) {
+        fresh = CONCURRENT_VECTOR_FAILED;
+    }
+
+    if (!vector_atomic_cas_ptr(&vec->segments[segment], &seg, fresh)) {
+        if (fresh != CONCURRENT_VECTOR_FAILED) {
+            vector_mem_free(vec->allocator, fresh, size);
+        }
+
+        fresh = seg;
+    }
+
+    return fresh == CONCURRENT_VECTOR_FAILED ? NULL : fresh;
+}
+
+static void concurrent_vector_release(ConcurrentVector *vec, const bool destroy) {
+    const size_t count = vec->reserved;
+
+    for (unsigned segment = 0; segment < CONCURRENT_VECTOR_MAX_SEGMENTS; ++segment) {
+        char *seg = (char *)vec->segments[segment];
+        if (NULL == seg || seg == CONCURRENT_VECTOR_FAILED) {
+            vec->segments[segment] = NULL;
+            continue;
+        }
+
+        const size_t start = concurrent_vector_segment_start(vec, segment);
+        const size_t seg_count = concurrent_vector_segment_count(vec, segment);
+
+        if (destroy && vec->destructor && start < count) {
+            const size_t used = count - start < seg_count ? count - start : seg_count;
+            for (size_t i = 0; i < used; ++i) {
+                vec->destructor(seg + i * vec->elem_size);
+            }
+        }
+
+        vector_mem_free(vec->allocator, seg, seg_count * vec->elem_size);
+
+        vec->segments[segment] = NULL;
+    }
+
+    vec->reserved = 0;
+
+    return;
+}
+
+ConcurrentVector *concurrent_vector_create(const size_t capacity,
+                                           const size_t elem_size,
+                                           void (*destructor)(void *)) {
+    return concurrent_vector_create_with_allocator(capacity, elem_size, destructor, NULL);
+}
+
+ConcurrentVector *concurrent_vector_create_with_allocator(const size_t capacity,
+                                                          const size_t elem_size,
+                                                          void (*destructor)(void *),
+                                                          const VectorAllocator *allocator) {
+    assert(elem_size > 0);
+    assert(allocator == NULL || allocator->allocate);
+
+    const VectorAllocator *used = vector_allocator_or_default(allocator);
+
+    size_t base = CONCURRENT_VECTOR_MIN_SEGMENT;
+    while (base < capacity && base <= SIZE_MAX / 4) {
+        base <<= 1;
+    }
+
+    ConcurrentVector *vec = (ConcurrentVector *)vector_mem_alloc(used, sizeof(ConcurrentVector));
+    if (NULL == vec) {
+        return NULL;
+    }
+
+    memset(vec, 0, sizeof(*vec));
+    vec->elem_size = elem_size;
+    vec->base = base;
+    vec->base_shift = vector_msb(base);
+    vec->destructor = destructor;
+    vec->allocator = used;
+    vec->user_allocator = allocator;
+
+    return vec;
+}
+
+void concurrent_vector_destroy(ConcurrentVector *vec) {
+    assert(vec);
+
+    concurrent_vector_release(vec, true);
+
+    vector_mem_free(vec->allocator, vec, sizeof(ConcurrentVector));
+
+    return;
+}
+
+void *concurrent_vector_emplace_back(ConcurrentVector *vec) {
+    assert(vec);
+
+    const size_t idx = vector_atomic_fetch_add(&vec->reserved, 1, VECTOR_RELAXED);
+    if (idx > SIZE_MAX - vec->base) {
+        return NULL;
+    }
+
+    size_t offset = 0;
+    const unsigned segment = vector_block_locate(vec->base, vec->base_shift, idx, &offset);
+
+    char *seg = (char *)concurrent_vector_segment(vec, segment);
+    if (NULL == seg) {
+        return NULL;
+    }
+
+    return seg + offset * vec->elem_size;
+}
+
+void *concurrent_vector_push_back(ConcurrentVector *vec, const void *elem) {
+    assert(vec && elem);
+
+    void *slot = concurrent_vector_emplace_back(vec);
+    if (NULL == slot) {
+        return NULL;
+    }
+
+    memcpy(slot, elem, vec->elem_size);
+
+    return slot;
+}
+
+bool concurrent_vector_reserve(ConcurrentVector *vec, const size_t capacity) {
+    assert(vec);
+
+    for (unsigned segment = 0; segment < CONCURRENT_VECTOR_MAX_SEGMENTS; ++segment) {
+        if (!concurrent_vector_segment_fits(vec, segment)) {
+            return false;
+        }
+
+        if (concurrent_vector_segment_start(vec, segment) >= capacity) {
+            return true;
+        }
+
+        if (NULL == concurrent_vector_segment(vec, segment)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t concurrent_vector_size(const ConcurrentVector *vec) {
+    assert(vec);
+
+    return vector_atomic_load(&vec->reserved, VECTOR_RELAXED);
+}
+
+void *concurrent_vector_at(const ConcurrentVector *vec, const size_t idx) {
+    assert(vec && idx < concurrent_vector_size(vec));
+
+    size_t offset = 0;
+    const unsigned segment = vector_block_locate(vec->base, vec->base_shift, idx, &offset);
+    char *seg = (char *)vector_atomic_load_ptr(&vec->segments[segment]);
+
+    assert(seg && seg != CONCURRENT_VECTOR_FAILED);
+
+    return seg + offset * vec->elem_size;
+}
+
+Vector *concurrent_vector_freeze(ConcurrentVector *vec) {
+    assert(vec);
+
+    const size_t count = vec->reserved;
+
+    Vector *frozen = vector_create_with_allocator(count, vec->elem_size, vec->destructor, vec->user_allocator);
+    if (NULL == frozen) {
+        return NULL;
+    }
+
+    for (unsigned segment = 0; segment < CONCURRENT_VECTOR_MAX_SEGMENTS; ++segment) {
+        const size_t start = concurrent_vector_segment_start(vec, segment);
+        if (start >= count) {
+            break;
+        }
+
+        const size_t seg_count = concurrent_vector_segment_count(vec, segment);
+        const size_t used = count - start < seg_count ? count - start : seg_count;
+        const void *seg = vec->segments[segment];
+
+        /* Slots of a missing segment were never published: leave them out. */
+        if (NULL == seg || seg == CONCURRENT_VECTOR_FAILED) {
+            continue;
+        }
+
+        /* Capacity was reserved for every slot, so this cannot fail. */
+        vector_append_n(frozen, seg, used);
+    }
+
+    concurrent_vector_release(vec, false);
+
+    return frozen;
+}
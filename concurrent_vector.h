@@ -0,0 +1,158 @@
+/**
+ * @file concurrent_vector.h
+ * @author itsjustgalileo
+ * @version 1.2
+ * @brief Append-only vector safe for concurrent producers.
+ */
+#ifndef CONCURRENT_VECTOR_H_
+#define CONCURRENT_VECTOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "vector.h"
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /**
+     * @brief Opaque concurrent append vector.
+     *
+     * Elements live in segments of doubling size that are never moved
+     * once allocated, so pointers to elements stay valid for the life
+     * of the vector. Slots are claimed with a single atomic increment:
+     * concurrent push_back calls never take a lock.
+     */
+    typedef struct ConcurrentVector ConcurrentVector;
+
+    /**
+     * @brief Create a new concurrent vector.
+     *
+     * @param capacity   Size of the first segment in elements, rounded up
+     *                   to a power of two (0 for a small default).
+     * @param elem_size  Size of a single element in bytes.
+     * @param destructor Optional per-element destructor. May be NULL.
+     *
+     * @return Pointer to a new ConcurrentVector, or NULL on allocation failure.
+     */
+    extern ConcurrentVector *concurrent_vector_create(size_t capacity,
+                                                      size_t elem_size,
+                                                      void (*destructor)(void *));
+
+    /**
+     * @brief Create a new concurrent vector using a custom allocator.
+     *
+     * The allocator must be safe to call from several threads at once.
+     *
+     * @param capacity   Size of the first segment in elements (0 for a small default).
+     * @param elem_size  Size of a single element in bytes.
+     * @param destructor Optional per-element destructor. May be NULL.
+     * @param allocator  Allocator to use, or NULL for malloc/free.
+     *                   Must outlive the vector and any frozen Vector.
+     *
+     * @return Pointer to a new ConcurrentVector, or NULL on allocation failure.
+     */
+    extern ConcurrentVector *concurrent_vector_create_with_allocator(size_t capacity,
+                                                                     size_t elem_size,
+                                                                     void (*destructor)(void *),
+                                                                     const VectorAllocator *allocator);
+
+    /**
+     * @brief Destroy a concurrent vector and release all resources.
+     *
+     * Calls the destructor on all published elements (if provided).
+     * No other thread may use the vector concurrently.
+     *
+     * @param vec Vector to destroy.
+     */
+    extern void concurrent_vector_destroy(ConcurrentVector *vec);
+
+    /**
+     * @brief Append an element. Safe to call from several threads at once.
+     *
+     * If the segment holding the claimed slot cannot be allocated,
+     * NULL is returned and every slot of that segment is lost: they
+     * still count towards the size, but are never handed out,
+     * destroyed or frozen.
+     *
+     * @param vec  Vector to append to.
+     * @param elem Pointer to element data to copy into the vector.
+     *
+     * @return Stable pointer to the new element, or NULL on allocation failure.
+     */
+    extern void *concurrent_vector_push_back(ConcurrentVector *vec, const void *elem);
+
+    /**
+     * @brief Claim an uninitialized slot. Safe to call from several threads at once.
+     *
+     * Same contract as concurrent_vector_push_back; the caller must
+     * construct the element in place.
+     *
+     * @param vec Vector to append to.
+     *
+     * @return Stable pointer to the new slot, or NULL on allocation failure.
+     */
+    extern void *concurrent_vector_emplace_back(ConcurrentVector *vec);
+
+    /**
+     * @brief Allocate segments up front for at least capacity elements.
+     *
+     * Avoids allocation on the push path. Safe to call concurrently
+     * with pushes.
+     *
+     * @param vec      Vector to reserve in.
+     * @param capacity Number of elements to make room for.
+     *
+     * @return true on success, false on allocation failure.
+     */
+    extern bool concurrent_vector_reserve(ConcurrentVector *vec, size_t capacity);
+
+    /**
+     * @brief Number of slots claimed so far.
+     *
+     * Under concurrent pushes this includes slots whose element is
+     * still being written.
+     *
+     * @param vec Vector to query.
+     *
+     * @return Number of claimed slots.
+     */
+    extern size_t concurrent_vector_size(const ConcurrentVector *vec);
+
+    /**
+     * @brief Get a pointer to the element at index.
+     *
+     * Only valid for slots whose push has completed and been made
+     * visible to the calling thread (e.g. by joining the producer).
+     *
+     * @param vec Vector to access.
+     * @param idx Index of the element.
+     *
+     * @return Pointer to element.
+     */
+    extern void *concurrent_vector_at(const ConcurrentVector *vec, size_t idx);
+
+    /**
+     * @brief Move all elements into a new contiguous Vector.
+     *
+     * Must only be called once producers are done. The new Vector
+     * takes over the destructor, allocator and elements; the
+     * concurrent vector is left empty and can be reused or destroyed.
+     *
+     * @param vec Vector to freeze.
+     *
+     * @return New Vector holding the published elements in index
+     *         order, without the slots lost to failed pushes,
+     *         or NULL on allocation failure (vec is then unchanged).
+     */
+    extern Vector *concurrent_vector_freeze(ConcurrentVector *vec);
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONCURRENT_VECTOR_H_ */
@@ -0,0 +1,330 @@
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "segmented_vector.h"
+#include "vector_internal.h"
+
+#define SEGMENTED_VECTOR_MAX_BLOCKS 64
+#define SEGMENTED_VECTOR_MIN_BLOCK 8
+
+/* Blocks double in size (see vector_block_locate). */
+struct SegmentedVector {
+    void *blocks[SEGMENTED_VECTOR_MAX_BLOCKS]; /**< Block storage; a prefix of blocks is allocated. */
+    size_t elem_size;                   /**< Size of one element in bytes. */
+    size_t elem_count;                  /**< Number of stored elements. */
+    size_t n_blocks;                    /**< Number of allocated blocks. */
+    size_t base;                        /**< Elements in block 0, a power of two. */
+    unsigned base_shift;                /**< log2(base). */
+    char *tail;                         /**< Next free slot, or NULL if the last block is full. */
+    char *tail_end;                     /**< End of the block holding tail. */
+    void (*destructor)(void *);         /**< Optional per-element destructor. */
+    const VectorAllocator *allocator;   /**< Allocator for header and blocks. */
+    const VectorAllocator *user_allocator; /**< Allocator handed to copies, or NULL. */
+};
+
+static size_t segmented_vector_block_count(const SegmentedVector *vec, const size_t block) {
+    return vector_block_size(vec->base, (unsigned)block);
+}
+
+static size_t segmented_vector_block_start(const SegmentedVector *vec, const size_t block) {
+    return vector_block_start(vec->base, (unsigned)block);
+}
+
+static char *segmented_vector_locate(const SegmentedVector *vec, const size_t idx) {
+    size_t offset = 0;
+    const unsigned block = vector_block_locate(vec->base, vec->base_shift, idx, &offset);
+
+    return (char *)vec->blocks[block] + offset * vec->elem_size;
+}
+
+/* Point tail at slot idx, which must lie in an allocated block. */
+static void segmented_vector_seek(SegmentedVector *vec, const size_t idx) {
+    if (idx == segmented_vector_capacity(vec)) {
+        vec->tail = NULL;
+        vec->tail_end = NULL;
+        return;
+    }
+
+    size_t offset = 0;
+    const unsigned block = vector_block_locate(vec->base, vec->base_shift, idx, &offset);
+
+    vec->tail = (char *)vec->blocks[block] + offset * vec->elem_size;
+    vec->tail_end = (char *)vec->blocks[block] + segmented_vector_block_count(vec, block) * vec->elem_size;
+
+    return;
+}
+
+static bool segmented_vector_add_block(SegmentedVector *vec) {
+    const size_t block = vec->n_blocks;
+    if (block >= SEGMENTED_VECTOR_MAX_BLOCKS || block + vec->base_shift >= sizeof(size_t) * 8 - 1) {
+        return false;
+    }
+
+    const size_t count = segmented_vector_block_count(vec, block);
+    if (count > SIZE_MAX / vec->elem_size) {
+        return false;
+    }
+
+    void *mem = vector_mem_alloc(vec->allocator, count * vec->elem_size);
+    if (NULL == mem) {
+        return false;
+    }
+
+    vec->blocks[block] = mem;
+    ++vec->n_blocks;
+
+    return true;
+}
+
+static void segmented_vector_destroy_elements(SegmentedVector *vec) {
+    if (vec->destructor) {
+        size_t count = 0;
+        char *ptr = NULL;
+        for (size_t block = 0; (ptr = (char *)segmented_vector_block(vec, block, &count)); ++block) {
+            for (size_t i = 0; i < count; ++i) {
+                vec->destructor(ptr + i * vec->elem_size);
+            }
+        }
+    }
+
+    return;
+}
+
+SegmentedVector *segmented_vector_create(const size_t capacity,
+                                         const size_t elem_size,
+                                         void (*destructor)(void *)) {
+    return segmented_vector_create_with_allocator(capacity, elem_size, destructor, NULL);
+}
+
+SegmentedVector *segmented_vector_create_with_allocator(const size_t capacity,
+                                                        const size_t elem_size,
+                                                        void (*destructor)(void *),
+                                                        const VectorAllocator *allocator) {
+    assert(elem_size > 0);
+    assert(allocator == NULL || allocator->allocate);
+
+    const VectorAllocator *used = vector_allocator_or_default(allocator);
+
+    size_t base = SEGMENTED_VECTOR_MIN_BLOCK;
+    while (base < capacity && base <= SIZE_MAX / 4) {
+        base <<= 1;
+    }
+
+    SegmentedVector *vec = (SegmentedVector *)vector_mem_alloc(used, sizeof(SegmentedVector));
+    if (NULL == vec) {
+        return NULL;
+    }
+
+    memset(vec, 0, sizeof(*vec));
+    vec->elem_size = elem_size;
+    vec->base = base;
+    vec->base_shift = vector_msb(base);
+    vec->destructor = destructor;
+    vec->allocator = used;
+    vec->user_allocator = allocator;
+
+    return vec;
+}
+
+void segmented_vector_destroy(SegmentedVector *vec) {
+    assert(vec);
+
+    segmented_vector_destroy_elements(vec);
+
+    vec->elem_count = 0;
+    segmented_vector_shrink_to_fit(vec);
+
+    vector_mem_free(vec->allocator, vec, sizeof(SegmentedVector));
+
+    return;
+}
+
+void segmented_vector_clear(SegmentedVector *vec) {
+    assert(vec);
+
+    segmented_vector_destroy_elements(vec);
+
+    vec->elem_count = 0;
+    segmented_vector_seek(vec, 0);
+
+    return;
+}
+
+void *segmented_vector_emplace_back(SegmentedVector *vec) {
+    assert(vec);
+
+    if (vec->tail == NULL) {
+        if (!segmented_vector_add_block(vec)) {
+            return NULL;
+        }
+
+        segmented_vector_seek(vec, vec->elem_count);
+    }
+
+    char *slot = vec->tail;
+
+    vec->tail += vec->elem_size;
+    if (vec->tail == vec->tail_end) {
+        vec->tail = NULL;
+        vec->tail_end = NULL;
+    }
+
+    ++vec->elem_count;
+
+    return slot;
+}
+
+void *segmented_vector_push_back(SegmentedVector *vec, const void *elem) {
+    assert(vec && elem);
+
+    void *slot = segmented_vector_emplace_back(vec);
+    if (NULL == slot) {
+        return NULL;
+    }
+
+    memcpy(slot, elem, vec->elem_size);
+
+    return slot;
+}
+
+bool segmented_vector_pop_back_into(SegmentedVector *vec, void *out) {
+    assert(vec && out);
+
+    if (vec->elem_count == 0) {
+        return false;
+    }
+
+    --vec->elem_count;
+    segmented_vector_seek(vec, vec->elem_count);
+
+    memcpy(out, vec->tail, vec->elem_size);
+
+    return true;
+}
+
+void segmented_vector_pop_back(SegmentedVector *vec) {
+    assert(vec && vec->elem_count);
+
+    --vec->elem_count;
+    segmented_vector_seek(vec, vec->elem_count);
+
+    if (vec->destructor) {
+        vec->destructor(vec->tail);
+    }
+
+    return;
+}
+
+void *segmented_vector_at(const SegmentedVector *vec, const size_t idx) {
+    assert(vec && idx < vec->elem_count);
+
+    return segmented_vector_locate(vec, idx);
+}
+
+void *segmented_vector_front(const SegmentedVector *vec) {
+    assert(vec);
+
+    return vec->elem_count ? vec->blocks[0] : NULL;
+}
+
+void *segmented_vector_back(const SegmentedVector *vec) {
+    assert(vec);
+
+    return vec->elem_count ? segmented_vector_locate(vec, vec->elem_count - 1) : NULL;
+}
+
+bool segmented_vector_reserve(SegmentedVector *vec, const size_t capacity) {
+    assert(vec);
+
+    const bool full = vec->tail == NULL;
+    bool ok = true;
+
+    while (ok && segmented_vector_capacity(vec) < capacity) {
+        ok = segmented_vector_add_block(vec);
+    }
+
+    if (full) {
+        segmented_vector_seek(vec, vec->elem_count);
+    }
+
+    return ok;
+}
+
+void segmented_vector_shrink_to_fit(SegmentedVector *vec) {
+    assert(vec);
+
+    while (vec->n_blocks > 0 && segmented_vector_block_start(vec, vec->n_blocks - 1) >= vec->elem_count) {
+        const size_t block = --vec->n_blocks;
+
+        vector_mem_free(vec->allocator, vec->blocks[block], segmented_vector_block_count(vec, block) * vec->elem_size);
+
+        vec->blocks[block] = NULL;
+    }
+
+    segmented_vector_seek(vec, vec->elem_count);
+
+    return;
+}
+
+size_t segmented_vector_size(const SegmentedVector *vec) {
+    assert(vec);
+
+    return vec->elem_count;
+}
+
+size_t segmented_vector_capacity(const SegmentedVector *vec) {
+    assert(vec);
+
+    return segmented_vector_block_start(vec, vec->n_blocks);
+}
+
+bool segmented_vector_is_empty(const SegmentedVector *vec) {
+    assert(vec);
+
+    return vec->elem_count == 0;
+}
+
+void *segmented_vector_block(const SegmentedVector *vec, const size_t block, size_t *count) {
+    assert(vec && count);
+
+    if (block >= vec->n_blocks) {
+        *count = 0;
+        return NULL;
+    }
+
+    const size_t start = segmented_vector_block_start(vec, block);
+    if (start >= vec->elem_count) {
+        *count = 0;
+        return NULL;
+    }
+
+    const size_t block_count = segmented_vector_block_count(vec, block);
+    *count = vec->elem_count - start < block_count ? vec->elem_count - start : block_count;
+
+    return vec->blocks[block];
+}
+
+Vector *segmented_vector_to_vector(const SegmentedVector *vec) {
+    assert(vec);
+
+    Vector *copy = vector_create_with_allocator(vec->elem_count, vec->elem_size, vec->destructor, vec->user_allocator);
+    if (NULL == copy) {
+        return NULL;
+    }
+
+    size_t count = 0;
+    const void *ptr = NULL;
+    for (size_t block = 0; (ptr = segmented_vector_block(vec, block, &count)); ++block) {
+        if (NULL == vector_append_n(copy, ptr, count)) {
+            /* The copied elements still belong to vec. */
+            vector_reset(copy);
+            vector_destroy(copy);
+            return NULL;
+        }
+    }
+
+    return copy;
+}
@@ -0,0 +1,226 @@
+/**
+ * @file segmented_vector.h
+ * @author itsjustgalileo
+ * @version 1.2
+ * @brief Dynamic array with stable element addresses.
+ */
+#ifndef SEGMENTED_VECTOR_H_
+#define SEGMENTED_VECTOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "vector.h"
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /**
+     * @brief Opaque segmented vector.
+     *
+     * Elements are stored in blocks of doubling size (block k holds
+     * capacity0 << k elements). Growing allocates one more block and
+     * never moves existing elements, so pointers returned by
+     * segmented_vector_at and segmented_vector_push_back stay valid
+     * until the element is removed, and no push ever copies the
+     * contents. Indexing is a bit scan plus two loads.
+     */
+    typedef struct SegmentedVector SegmentedVector;
+
+    /**
+     * @brief Create a new segmented vector.
+     *
+     * @param capacity   Size of the first block in elements, rounded up
+     *                   to a power of two (0 for a small default).
+     * @param elem_size  Size of a single element in bytes.
+     * @param destructor Optional per-element destructor. May be NULL.
+     *
+     * @return Pointer to a new SegmentedVector, or NULL on allocation failure.
+     */
+    extern SegmentedVector *segmented_vector_create(size_t capacity,
+                                                    size_t elem_size,
+                                                    void (*destructor)(void *));
+
+    /**
+     * @brief Create a new segmented vector using a custom allocator.
+     *
+     * @param capacity   Size of the first block in elements (0 for a small default).
+     * @param elem_size  Size of a single element in bytes.
+     * @param destructor Optional per-element destructor. May be NULL.
+     * @param allocator  Allocator to use, or NULL for malloc/free.
+     *
+     * @return Pointer to a new SegmentedVector, or NULL on allocation failure.
+     */
+    extern SegmentedVector *segmented_vector_create_with_allocator(size_t capacity,
+                                                                   size_t elem_size,
+                                                                   void (*destructor)(void *),
+                                                                   const VectorAllocator *allocator);
+
+    /**
+     * @brief Destroy a segmented vector and release all resources.
+     *
+     * Calls the destructor on all stored elements (if provided).
+     *
+     * @param vec Vector to destroy.
+     */
+    extern void segmented_vector_destroy(SegmentedVector *vec);
+
+    /**
+     * @brief Remove all elements from the vector.
+     *
+     * Calls the destructor on each element (if provided).
+     * Blocks are kept.
+     *
+     * @param vec Vector to clear.
+     */
+    extern void segmented_vector_clear(SegmentedVector *vec);
+
+    /**
+     * @brief Append an element to the end of the vector.
+     *
+     * @param vec  Vector to append to.
+     * @param elem Pointer to element data to copy into the vector.
+     *
+     * @return Stable pointer to the new element, or NULL on allocation failure.
+     */
+    extern void *segmented_vector_push_back(SegmentedVector *vec, const void *elem);
+
+    /**
+     * @brief Append an uninitialized slot to the end of the vector.
+     *
+     * The caller must construct the element in place.
+     *
+     * @param vec Vector to append to.
+     *
+     * @return Stable pointer to the new slot, or NULL on allocation failure.
+     */
+    extern void *segmented_vector_emplace_back(SegmentedVector *vec);
+
+    /**
+     * @brief Remove the last element, moving it into caller storage.
+     *
+     * The destructor is NOT called.
+     *
+     * @param vec Vector to pop from.
+     * @param out Buffer of elem_size bytes receiving the element.
+     *
+     * @return true if an element was removed, false if the vector was empty.
+     */
+    extern bool segmented_vector_pop_back_into(SegmentedVector *vec, void *out);
+
+    /**
+     * @brief Remove and destroy the last element.
+     *
+     * Calls the destructor on the element (if provided).
+     *
+     * @param vec Vector to pop from. Must not be empty.
+     */
+    extern void segmented_vector_pop_back(SegmentedVector *vec);
+
+    /**
+     * @brief Get a pointer to the element at index.
+     *
+     * @param vec Vector to access.
+     * @param idx Index of the element.
+     *
+     * @return Pointer to element.
+     */
+    extern void *segmented_vector_at(const SegmentedVector *vec, size_t idx);
+
+    /**
+     * @brief Get a pointer to the first element.
+     *
+     * @param vec Vector to access.
+     *
+     * @return Pointer to first element, or NULL if empty.
+     */
+    extern void *segmented_vector_front(const SegmentedVector *vec);
+
+    /**
+     * @brief Get a pointer to the last element.
+     *
+     * @param vec Vector to access.
+     *
+     * @return Pointer to last element, or NULL if empty.
+     */
+    extern void *segmented_vector_back(const SegmentedVector *vec);
+
+    /**
+     * @brief Allocate blocks up front for at least capacity elements.
+     *
+     * @param vec      Vector to reserve in.
+     * @param capacity Number of elements to make room for.
+     *
+     * @return true on success, false on allocation failure.
+     */
+    extern bool segmented_vector_reserve(SegmentedVector *vec, size_t capacity);
+
+    /**
+     * @brief Release blocks that hold no elements.
+     *
+     * @param vec Vector to shrink.
+     */
+    extern void segmented_vector_shrink_to_fit(SegmentedVector *vec);
+
+    /**
+     * @brief Get the number of elements stored.
+     *
+     * @param vec Vector to query.
+     *
+     * @return Number of elements.
+     */
+    extern size_t segmented_vector_size(const SegmentedVector *vec);
+
+    /**
+     * @brief Get the number of elements the allocated blocks can hold.
+     *
+     * @param vec Vector to query.
+     *
+     * @return Capacity in elements.
+     */
+    extern size_t segmented_vector_capacity(const SegmentedVector *vec);
+
+    /**
+     * @brief Check whether the vector is empty.
+     *
+     * @param vec Vector to query.
+     *
+     * @return true if empty, false otherwise.
+     */
+    extern bool segmented_vector_is_empty(const SegmentedVector *vec);
+
+    /**
+     * @brief Get one contiguous block of elements.
+     *
+     * Loops can walk blocks with this to avoid per-element index
+     * math: for (k = 0; (p = segmented_vector_block(vec, k, &n)); ++k).
+     *
+     * @param vec   Vector to access.
+     * @param block Block index.
+     * @param count Receives the number of elements stored in the block.
+     *
+     * @return Pointer to the first element of the block, or NULL once
+     *         past the last element.
+     */
+    extern void *segmented_vector_block(const SegmentedVector *vec, size_t block, size_t *count);
+
+    /**
+     * @brief Copy the elements into a new contiguous Vector.
+     *
+     * The destructor pointer is copied as-is.
+     *
+     * @param vec Vector to copy.
+     *
+     * @return New Vector with the same elements, or NULL on allocation failure.
+     */
+    extern Vector *segmented_vector_to_vector(const SegmentedVector *vec);
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SEGMENTED_VECTOR_H_ */
@@ -0,0 +1,225 @@
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "soa_vector.h"
+#include "vector_internal.h"
+
+struct SoAVector {
+    size_t n_columns;                   /**< Number of columns. */
+    const VectorAllocator *allocator;   /**< Allocator for the header. */
+    Vector *columns[];                  /**< One Vector per column, all of equal size. */
+};
+
+static size_t soa_vector_header_size(const size_t n_columns) {
+    return sizeof(SoAVector) + n_columns * sizeof(Vector *);
+}
+
+SoAVector *soa_vector_create(const size_t *column_sizes, const size_t n_columns, const size_t capacity) {
+    return soa_vector_create_with_allocator(column_sizes, n_columns, capacity, NULL);
+}
+
+SoAVector *soa_vector_create_with_allocator(const size_t *column_sizes,
+                                            const size_t n_columns,
+                                            const size_t capacity,
+                                            const VectorAllocator *allocator) {
+    assert(column_sizes && n_columns > 0);
+    assert(allocator == NULL || allocator->allocate);
+
+    const VectorAllocator *used = vector_allocator_or_default(allocator);
+
+    if (n_columns > (SIZE_MAX - sizeof(SoAVector)) / sizeof(Vector *)) {
+        return NULL;
+    }
+
+    SoAVector *vec = (SoAVector *)vector_mem_alloc(used, soa_vector_header_size(n_columns));
+    if (NULL == vec) {
+        return NULL;
+    }
+
+    vec->n_columns = n_columns;
+    vec->allocator = used;
+
+    for (size_t col = 0; col < n_columns; ++col) {
+        vec->columns[col] = vector_create_with_allocator(capacity, column_sizes[col], NULL, allocator);
+        if (NULL == vec->columns[col]) {
+            vec->n_columns = col;
+            soa_vector_destroy(vec);
+            return NULL;
+        }
+    }
+
+    return vec;
+}
+
+void soa_vector_destroy(SoAVector *vec) {
+    assert(vec);
+
+    for (size_t col = 0; col < vec->n_columns; ++col) {
+        vector_destroy(vec->columns[col]);
+    }
+
+    vector_mem_free(vec->allocator, vec, soa_vector_header_size(vec->n_columns));
+
+    return;
+}
+
+void soa_vector_clear(SoAVector *vec) {
+    assert(vec);
+
+    for (size_t col = 0; col < vec->n_columns; ++col) {
+        vector_clear(vec->columns[col]);
+    }
+
+    return;
+}
+
+/* Drop the row just appended to the first count columns. */
+static void soa_vector_rollback(SoAVector *vec, size_t count) {
+    while (count-- > 0) {
+        vector_pop_back_n(vec->columns[count], 1, NULL);
+    }
+
+    return;
+}
+
+bool soa_vector_push_back(SoAVector *vec, const void *const *fields) {
+    assert(vec && fields);
+
+    for (size_t col = 0; col < vec->n_columns; ++col) {
+        if (NULL == vector_push_back(vec->columns[col], fields[col])) {
+            soa_vector_rollback(vec, col);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool soa_vector_emplace_back(SoAVector *vec) {
+    assert(vec);
+
+    for (size_t col = 0; col < vec->n_columns; ++col) {
+        if (NULL == vector_emplace_back(vec->columns[col])) {
+            soa_vector_rollback(vec, col);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void soa_vector_pop_back(SoAVector *vec) {
+    assert(vec && !soa_vector_is_empty(vec));
+
+    for (size_t col = 0; col < vec->n_columns; ++col) {
+        vector_pop_back_n(vec->columns[col], 1, NULL);
+    }
+
+    return;
+}
+
+bool soa_vector_erase(SoAVector *vec, const size_t row) {
+    assert(vec);
+
+    if (row >= soa_vector_size(vec)) {
+        return false;
+    }
+
+    for (size_t col = 0; col < vec->n_columns; ++col) {
+        vector_erase(vec->columns[col], row);
+    }
+
+    return true;
+}
+
+bool soa_vector_swap_remove(SoAVector *vec, const size_t row) {
+    assert(vec);
+
+    if (row >= soa_vector_size(vec)) {
+        return false;
+    }
+
+    for (size_t col = 0; col < vec->n_columns; ++col) {
+        vector_swap_remove(vec->columns[col], row);
+    }
+
+    return true;
+}
+
+bool soa_vector_reserve(SoAVector *vec, const size_t capacity) {
+    assert(vec);
+
+    for (size_t col = 0; col < vec->n_columns; ++col) {
+        if (vector_capacity(vec->columns[col]) < capacity && !vector_reserve(vec->columns[col], capacity)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool soa_vector_shrink_to_fit(SoAVector *vec) {
+    assert(vec);
+
+    const size_t rows = vector_size(vec->columns[0]) == 0 ? 1 : vector_size(vec->columns[0]);
+
+    bool ok = true;
+    for (size_t col = 0; col < vec->n_columns; ++col) {
+        if (vector_capacity(vec->columns[col]) > rows && !vector_shrink_to_fit(vec->columns[col])) {
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+size_t soa_vector_size(const SoAVector *vec) {
+    assert(vec);
+
+    return vector_size(vec->columns[0]);
+}
+
+size_t soa_vector_capacity(const SoAVector *vec) {
+    assert(vec);
+
+    size_t capacity = vector_capacity(vec->columns[0]);
+    for (size_t col = 1; col < vec->n_columns; ++col) {
+        const size_t cap = vector_capacity(vec->columns[col]);
+        capacity = cap < capacity ? cap : capacity;
+    }
+
+    return capacity;
+}
+
+bool soa_vector_is_empty(const SoAVector *vec) {
+    assert(vec);
+
+    return vector_is_empty(vec->columns[0]);
+}
+
+size_t soa_vector_columns(const SoAVector *vec) {
+    assert(vec);
+
+    return vec->n_columns;
+}
+
+void *soa_vector_column_data(const SoAVector *vec, const size_t col) {
+    assert(vec && col < vec->n_columns);
+
+    return vector_data(vec->columns[col]);
+}
+
+const Vector *soa_vector_column(const SoAVector *vec, const size_t col) {
+    assert(vec && col < vec->n_columns);
+
+    return vec->columns[col];
+}
+
+void *soa_vector_at(const SoAVector *vec, const size_t col, const size_t row) {
+    assert(vec && col < vec->n_columns);
+
+    return vector_at(vec->columns[col], row);
+}
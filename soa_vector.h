@@ -0,0 +1,222 @@
+/**
+ * @file soa_vector.h
+ * @author itsjustgalileo
+ * @version 1.2
+ * @brief Structure-of-arrays vector with one contiguous array per column.
+ */
+#ifndef SOA_VECTOR_H_
+#define SOA_VECTOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "vector.h"
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /**
+     * @brief Opaque structure-of-arrays vector.
+     *
+     * Each column is a Vector of its own element size, so a scan over
+     * one field reads only that field's bytes. All columns always
+     * hold the same number of rows: every operation is applied to
+     * every column, and a push that fails leaves no column changed.
+     * Columns hold plain data; no destructors are run.
+     */
+    typedef struct SoAVector SoAVector;
+
+    /**
+     * @brief Create a new structure-of-arrays vector.
+     *
+     * @param column_sizes Element size in bytes of each column.
+     * @param n_columns    Number of columns (at least 1).
+     * @param capacity     Initial capacity in rows.
+     *
+     * @return Pointer to a new SoAVector, or NULL on allocation failure.
+     */
+    extern SoAVector *soa_vector_create(const size_t *column_sizes, size_t n_columns, size_t capacity);
+
+    /**
+     * @brief Create a new structure-of-arrays vector using a custom allocator.
+     *
+     * @param column_sizes Element size in bytes of each column.
+     * @param n_columns    Number of columns (at least 1).
+     * @param capacity     Initial capacity in rows.
+     * @param allocator    Allocator to use for the header and every column,
+     *                     or NULL for malloc/free.
+     *
+     * @return Pointer to a new SoAVector, or NULL on allocation failure.
+     */
+    extern SoAVector *soa_vector_create_with_allocator(const size_t *column_sizes,
+                                                       size_t n_columns,
+                                                       size_t capacity,
+                                                       const VectorAllocator *allocator);
+
+    /**
+     * @brief Destroy a structure-of-arrays vector and release all resources.
+     *
+     * @param vec Vector to destroy.
+     */
+    extern void soa_vector_destroy(SoAVector *vec);
+
+    /**
+     * @brief Remove all rows. Capacity is kept.
+     *
+     * @param vec Vector to clear.
+     */
+    extern void soa_vector_clear(SoAVector *vec);
+
+    /**
+     * @brief Append a row.
+     *
+     * @param vec    Vector to append to.
+     * @param fields One pointer per column to the value to copy in.
+     *
+     * @return true on success, false on allocation failure (vec is then unchanged).
+     */
+    extern bool soa_vector_push_back(SoAVector *vec, const void *const *fields);
+
+    /**
+     * @brief Append an uninitialized row.
+     *
+     * The caller must fill every column of the new row in place,
+     * e.g. through soa_vector_at.
+     *
+     * @param vec Vector to append to.
+     *
+     * @return true on success, false on allocation failure (vec is then unchanged).
+     */
+    extern bool soa_vector_emplace_back(SoAVector *vec);
+
+    /**
+     * @brief Remove the last row.
+     *
+     * @param vec Vector to pop from. Must not be empty.
+     */
+    extern void soa_vector_pop_back(SoAVector *vec);
+
+    /**
+     * @brief Erase a row, shifting the following rows down in every column.
+     *
+     * @param vec Vector to modify.
+     * @param row Index of the row to erase.
+     *
+     * @return true on success.
+     */
+    extern bool soa_vector_erase(SoAVector *vec, size_t row);
+
+    /**
+     * @brief Erase a row by moving the last row into its place.
+     *
+     * O(1) per column, but does not preserve row order.
+     *
+     * @param vec Vector to modify.
+     * @param row Index of the row to erase.
+     *
+     * @return true on success.
+     */
+    extern bool soa_vector_swap_remove(SoAVector *vec, size_t row);
+
+    /**
+     * @brief Ensure every column can hold at least capacity rows.
+     *
+     * @param vec      Vector to reserve in.
+     * @param capacity Number of rows to make room for.
+     *
+     * @return true on success, false on allocation failure.
+     */
+    extern bool soa_vector_reserve(SoAVector *vec, size_t capacity);
+
+    /**
+     * @brief Shrink every column's capacity to its size.
+     *
+     * @param vec Vector to shrink.
+     *
+     * @return true on success, false if any column could not be shrunk.
+     */
+    extern bool soa_vector_shrink_to_fit(SoAVector *vec);
+
+    /**
+     * @brief Get the number of rows.
+     *
+     * @param vec Vector to query.
+     *
+     * @return Number of rows.
+     */
+    extern size_t soa_vector_size(const SoAVector *vec);
+
+    /**
+     * @brief Get the number of rows every column can hold without reallocating.
+     *
+     * @param vec Vector to query.
+     *
+     * @return Capacity in rows.
+     */
+    extern size_t soa_vector_capacity(const SoAVector *vec);
+
+    /**
+     * @brief Check whether the vector has no rows.
+     *
+     * @param vec Vector to query.
+     *
+     * @return true if empty, false otherwise.
+     */
+    extern bool soa_vector_is_empty(const SoAVector *vec);
+
+    /**
+     * @brief Get the number of columns.
+     *
+     * @param vec Vector to query.
+     *
+     * @return Number of columns.
+     */
+    extern size_t soa_vector_columns(const SoAVector *vec);
+
+    /**
+     * @brief Get a pointer to one column's contiguous storage.
+     *
+     * The pointer is invalidated by any operation that adds rows or
+     * changes the capacity.
+     *
+     * @param vec Vector to access.
+     * @param col Column index.
+     *
+     * @return Pointer to the first element of the column.
+     */
+    extern void *soa_vector_column_data(const SoAVector *vec, size_t col);
+
+    /**
+     * @brief Get one column as a read-only Vector.
+     *
+     * Lets read-only Vector functions such as vector_parallel_reduce
+     * run over a single column. The column must not be modified
+     * through vector_* calls.
+     *
+     * @param vec Vector to access.
+     * @param col Column index.
+     *
+     * @return Column vector.
+     */
+    extern const Vector *soa_vector_column(const SoAVector *vec, size_t col);
+
+    /**
+     * @brief Get a pointer to one field of a row.
+     *
+     * @param vec Vector to access.
+     * @param col Column index.
+     * @param row Row index.
+     *
+     * @return Pointer to the field.
+     */
+    extern void *soa_vector_at(const SoAVector *vec, size_t col, size_t row);
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SOA_VECTOR_H_ */
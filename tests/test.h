@@ -0,0 +1,26 @@
+/**
+ * @file test.h
+ * @author itsjustgalileo
+ * @version 1.2
+ * @brief Minimal check macros shared by the tests run by `make check`.
+ */
+#ifndef VECTOR_TEST_H_
+#define VECTOR_TEST_H_
+
+#include <stdio.h>
+
+static int test_failures;
+
+/* Report a failed condition and keep going, so one run lists every failure. */
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++test_failures;                                                     \
+        }                                                                        \
+    } while (0)
+
+/* Exit status for main: 0 when every check passed. */
+#define TEST_RESULT() (test_failures == 0 ? 0 : 1)
+
+#endif /* VECTOR_TEST_H_ */
@@ -0,0 +1,44 @@
+#include <stdint.h>
+
+#include "../bit_vector.h"
+#include "test.h"
+
+static void test_rank_select(void) {
+    BitVector *vec = bit_vector_create(0);
+
+    for (size_t i = 0; i < 5000; ++i) {
+        bit_vector_push_back(vec, i % 3 == 0);
+    }
+
+    CHECK(bit_vector_count(vec) == 1667);
+    CHECK(bit_vector_build_index(vec));
+    CHECK(bit_vector_rank(vec, 0) == 0 && bit_vector_rank(vec, 3000) == 1000);
+    CHECK(bit_vector_select(vec, 1000) == 3000);
+    CHECK(bit_vector_select(vec, 1667) == bit_vector_size(vec));
+
+    bit_vector_not(vec);
+    CHECK(bit_vector_count(vec) == 5000 - 1667 && !bit_vector_get(vec, 0));
+
+    bit_vector_destroy(vec);
+}
+
+static void test_packed(void) {
+    PackedVector *vec = packed_vector_create(5, 0);
+
+    for (uint64_t i = 0; i < 200; ++i) {
+        packed_vector_push_back(vec, i & 31);
+    }
+
+    packed_vector_set(vec, 13, 30);
+    CHECK(packed_vector_get(vec, 13) == 30 && packed_vector_get(vec, 12) == 12 && packed_vector_get(vec, 14) == 14);
+    CHECK(packed_vector_pop_back(vec) == (199 & 31) && packed_vector_size(vec) == 199);
+
+    packed_vector_destroy(vec);
+}
+
+int main(void) {
+    test_rank_select();
+    test_packed();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,108 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "../concurrent_vector.h"
+#include "test.h"
+
+#define TEST_THREADS 4
+#define TEST_PUSHES 10000
+
+static int allocations;
+static int fail_at;
+static size_t destroyed;
+
+static void *fail_allocate(void *ctx, size_t size) {
+    (void)ctx;
+
+    return ++allocations == fail_at ? NULL : malloc(size);
+}
+
+static void fail_deallocate(void *ctx, void *ptr, size_t size) {
+    (void)ctx;
+    (void)size;
+
+    free(ptr);
+
+    return;
+}
+
+static void count_destructor(void *elem) {
+    /* Only published elements, never zero-filled failed slots, are destroyed. */
+    CHECK(*(int *)elem != 0);
+    ++destroyed;
+
+    return;
+}
+
+static void *test_push(void *arg) {
+    ConcurrentVector *vec = (ConcurrentVector *)arg;
+
+    for (int i = 1; i <= TEST_PUSHES; ++i) {
+        concurrent_vector_push_back(vec, &i);
+    }
+
+    return NULL;
+}
+
+static void test_threaded_push(void) {
+    ConcurrentVector *vec = concurrent_vector_create(0, sizeof(int), NULL);
+    pthread_t threads[TEST_THREADS];
+
+    for (int t = 0; t < TEST_THREADS; ++t) {
+        pthread_create(&threads[t], NULL, test_push, vec);
+    }
+    for (int t = 0; t < TEST_THREADS; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+
+    CHECK(concurrent_vector_size(vec) == TEST_THREADS * TEST_PUSHES);
+
+    Vector *frozen = concurrent_vector_freeze(vec);
+    CHECK(frozen && vector_size(frozen) == TEST_THREADS * TEST_PUSHES);
+    CHECK(concurrent_vector_size(vec) == 0);
+
+    long long sum = 0;
+    for (size_t i = 0; i < vector_size(frozen); ++i) {
+        sum += *(int *)vector_at(frozen, i);
+    }
+    CHECK(sum == (long long)TEST_THREADS * TEST_PUSHES * (TEST_PUSHES + 1) / 2);
+
+    vector_destroy(frozen);
+    concurrent_vector_destroy(vec);
+}
+
+static void test_failed_segment(void) {
+    const VectorAllocator allocator = {fail_allocate, NULL, fail_deallocate, NULL};
+
+    /* Allocation 1 is the header, 2 the first segment (8), 3 the second (16). */
+    allocations = 0;
+    fail_at = 3;
+    destroyed = 0;
+
+    ConcurrentVector *vec = concurrent_vector_create_with_allocator(8, sizeof(int), count_destructor, &allocator);
+
+    size_t pushed = 0;
+    for (int i = 1; i <= 40; ++i) {
+        pushed += NULL != concurrent_vector_push_back(vec, &i);
+    }
+    CHECK(pushed == 8 + 16);
+
+    Vector *frozen = concurrent_vector_freeze(vec);
+    CHECK(frozen && vector_size(frozen) == 24 && *(int *)vector_at(frozen, 8) == 25);
+    vector_destroy(frozen);
+    CHECK(destroyed == 24);
+
+    for (int i = 1; i <= 20; ++i) {
+        concurrent_vector_push_back(vec, &i);
+    }
+    concurrent_vector_destroy(vec);
+    CHECK(destroyed == 44);
+}
+
+int main(void) {
+    test_threaded_push();
+    test_failed_segment();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,92 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../segmented_vector.h"
+#include "test.h"
+
+static size_t live;
+static bool out_of_memory;
+
+static void *limited_allocate(void *ctx, size_t size) {
+    (void)ctx;
+
+    if (out_of_memory) {
+        return NULL;
+    }
+
+    ++live;
+
+    return malloc(size);
+}
+
+static void limited_deallocate(void *ctx, void *ptr, size_t size) {
+    (void)ctx;
+    (void)size;
+
+    --live;
+    free(ptr);
+
+    return;
+}
+
+static void test_push_at(void) {
+    SegmentedVector *vec = segmented_vector_create(4, sizeof(int), NULL);
+
+    void *first = NULL;
+    for (int i = 0; i < 1000; ++i) {
+        void *slot = segmented_vector_push_back(vec, &i);
+        first = 0 == i ? slot : first;
+    }
+
+    /* Elements never move once pushed. */
+    CHECK(segmented_vector_at(vec, 0) == first);
+    CHECK(segmented_vector_size(vec) == 1000);
+
+    bool indexed = true;
+    for (size_t i = 0; i < 1000; ++i) {
+        indexed = indexed && *(int *)segmented_vector_at(vec, i) == (int)i;
+    }
+    CHECK(indexed);
+
+    int out = 0;
+    CHECK(segmented_vector_pop_back_into(vec, &out) && out == 999);
+    CHECK(*(int *)segmented_vector_back(vec) == 998);
+
+    Vector *flat = segmented_vector_to_vector(vec);
+    CHECK(flat && vector_size(flat) == 999 && *(int *)vector_at(flat, 998) == 998);
+
+    vector_destroy(flat);
+    segmented_vector_destroy(vec);
+}
+
+static void test_allocator(void) {
+    const VectorAllocator allocator = {limited_allocate, NULL, limited_deallocate, NULL};
+    SegmentedVector *vec = segmented_vector_create_with_allocator(4, sizeof(int), NULL, &allocator);
+
+    for (int i = 0; i < 100; ++i) {
+        segmented_vector_push_back(vec, &i);
+    }
+
+    out_of_memory = true;
+    const int value = 100;
+    while (segmented_vector_size(vec) < segmented_vector_capacity(vec)) {
+        CHECK(segmented_vector_push_back(vec, &value));
+    }
+    CHECK(NULL == segmented_vector_push_back(vec, &value));
+    CHECK(NULL == segmented_vector_to_vector(vec));
+    out_of_memory = false;
+
+    Vector *flat = segmented_vector_to_vector(vec);
+    CHECK(flat && vector_size(flat) == segmented_vector_size(vec) && *(int *)vector_at(flat, 99) == 99);
+
+    vector_destroy(flat);
+    segmented_vector_destroy(vec);
+    CHECK(live == 0);
+}
+
+int main(void) {
+    test_push_at();
+    test_allocator();
+
+    return TEST_RESULT();
+}
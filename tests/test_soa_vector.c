@@ -0,0 +1,46 @@
+#include <stdint.h>
+
+#include "../soa_vector.h"
+#include "test.h"
+
+static void test_push_erase(void) {
+    const size_t sizes[2] = {sizeof(int), sizeof(double)};
+    SoAVector *vec = soa_vector_create(sizes, 2, 0);
+
+    for (int i = 0; i < 10; ++i) {
+        const double d = i * 0.5;
+        const void *fields[2] = {&i, &d};
+        CHECK(soa_vector_push_back(vec, fields));
+    }
+
+    CHECK(soa_vector_size(vec) == 10);
+    CHECK(soa_vector_erase(vec, 0));
+    CHECK(*(int *)soa_vector_at(vec, 0, 0) == 1 && *(double *)soa_vector_at(vec, 1, 0) == 0.5);
+    CHECK(soa_vector_swap_remove(vec, 0));
+    CHECK(*(int *)soa_vector_at(vec, 0, 0) == 9 && soa_vector_size(vec) == 8);
+
+    soa_vector_destroy(vec);
+}
+
+static void test_reserve_shrink(void) {
+    const size_t sizes[3] = {1, 8, 4};
+    SoAVector *vec = soa_vector_create(sizes, 3, 4);
+
+    CHECK(soa_vector_reserve(vec, 50));
+    CHECK(soa_vector_capacity(vec) >= 50);
+    /* Already big enough: nothing to do is not a failure. */
+    CHECK(soa_vector_reserve(vec, 10));
+
+    CHECK(soa_vector_shrink_to_fit(vec));
+    CHECK(soa_vector_capacity(vec) == 1);
+    CHECK(soa_vector_shrink_to_fit(vec));
+
+    soa_vector_destroy(vec);
+}
+
+int main(void) {
+    test_push_erase();
+    test_reserve_shrink();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,686 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VECTOR_EXPOSE_LAYOUT
+#include "../vector.h"
+#include "test.h"
+
+VECTOR_DEFINE(IntVector, int)
+
+static size_t destroyed;
+
+static void count_destructor(void *elem) {
+    (void)elem;
+
+    ++destroyed;
+
+    return;
+}
+
+static Vector *make_ints(const int count, void (*destructor)(void *)) {
+    Vector *vec = vector_create(0, sizeof(int), destructor);
+
+    for (int i = 0; i < count; ++i) {
+        vector_push_back(vec, &i);
+    }
+
+    return vec;
+}
+
+static bool ints_are(const Vector *vec, const int *expected, const size_t count) {
+    return vector_size(vec) == count && memcmp(vector_data(vec), expected, count * sizeof(int)) == 0;
+}
+
+static size_t range_calls;
+
+static void count_range(void *first, size_t count) {
+    (void)first;
+
+    ++range_calls;
+    destroyed += count;
+
+    return;
+}
+
+static bool is_odd(const void *elem, void *ctx) {
+    (void)ctx;
+
+    return *(const int *)elem & 1;
+}
+
+typedef struct TestPair {
+    int32_t key;
+    int32_t order;
+} TestPair;
+
+static int compare_pairs_desc(const void *a, const void *b) {
+    const int32_t x = ((const TestPair *)a)->key;
+    const int32_t y = ((const TestPair *)b)->key;
+
+    return (x < y) - (x > y);
+}
+
+typedef struct TestAllocator {
+    size_t live;
+    size_t calls;
+} TestAllocator;
+
+static void *test_allocate(void *ctx, size_t size) {
+    TestAllocator *allocator = (TestAllocator *)ctx;
+
+    ++allocator->live;
+    ++allocator->calls;
+
+    return malloc(size);
+}
+
+static void test_deallocate(void *ctx, void *ptr, size_t size) {
+    (void)size;
+
+    --((TestAllocator *)ctx)->live;
+    free(ptr);
+
+    return;
+}
+
+static int fail_at = -1;
+
+static bool copy_int(void *dst, const void *src, void *ctx) {
+    (void)ctx;
+
+    if (*(const int *)src == fail_at) {
+        return false;
+    }
+
+    *(int *)dst = *(const int *)src;
+
+    return true;
+}
+
+static bool copy_ints(void *dst, const void *src, const size_t count, void *ctx) {
+    (void)ctx;
+
+    memcpy(dst, src, count * sizeof(int));
+
+    return true;
+}
+
+static void test_push_pop(void) {
+    destroyed = 0;
+
+    Vector *vec = make_ints(100, count_destructor);
+
+    CHECK(vector_size(vec) == 100 && vector_capacity(vec) >= 100);
+    CHECK(*(int *)vector_at(vec, 42) == 42);
+    CHECK(*(int *)vector_front(vec) == 0 && *(int *)vector_back(vec) == 99);
+
+    int out = 0;
+    CHECK(vector_pop_back_into(vec, &out) && out == 99 && destroyed == 0);
+
+    CHECK(*(int *)vector_take_back(vec) == 98);
+
+    CHECK(vector_pop_back_n(vec, 2, NULL) && destroyed == 2);
+    CHECK(vector_erase(vec, 0) && *(int *)vector_front(vec) == 1 && destroyed == 3);
+    CHECK(vector_size(vec) == 95);
+
+    vector_clear(vec);
+    CHECK(vector_is_empty(vec) && destroyed == 98);
+
+    vector_destroy(vec);
+}
+
+static void test_bulk(void) {
+    const int head[3] = {0, 1, 2};
+    const int middle[2] = {7, 8};
+    Vector *vec = vector_create(0, sizeof(int), NULL);
+
+    CHECK(vector_append_n(vec, head, 3));
+    CHECK(vector_insert_range(vec, 1, middle, 2));
+
+    const int inserted[5] = {0, 7, 8, 1, 2};
+    CHECK(ints_are(vec, inserted, 5));
+
+    CHECK(vector_erase_range(vec, 0, 2));
+
+    const int erased[3] = {8, 1, 2};
+    CHECK(ints_are(vec, erased, 3));
+
+    vector_destroy(vec);
+}
+
+static void test_allocator(void) {
+    TestAllocator counts = {0, 0};
+    const VectorAllocator allocator = {test_allocate, NULL, test_deallocate, &counts};
+    Vector *vec = vector_create_with_allocator(1, sizeof(int), NULL, &allocator);
+
+    for (int i = 0; i < 1000; ++i) {
+        vector_push_back(vec, &i);
+    }
+
+    Vector *copy = vector_clone(vec);
+    CHECK(copy && *(int *)vector_at(copy, 999) == 999);
+    CHECK(counts.calls > 2 && counts.live > 0);
+
+    vector_destroy(copy);
+    vector_destroy(vec);
+    CHECK(counts.live == 0);
+}
+
+static void test_growth(void) {
+    const VectorGrowthPolicy linear = {VECTOR_GROWTH_LINEAR, 10, 0, false, NULL, NULL};
+    Vector *vec = vector_create(10, sizeof(int), NULL);
+
+    vector_set_growth_policy(vec, &linear);
+    for (int i = 0; i < 11; ++i) {
+        vector_push_back(vec, &i);
+    }
+    CHECK(vector_capacity(vec) == 20);
+
+    CHECK(!vector_reserve(vec, SIZE_MAX / 2));
+    CHECK(vector_capacity(vec) == 20 && *(int *)vector_at(vec, 10) == 10);
+
+    vector_destroy(vec);
+}
+
+static void test_inline(void) {
+    Vector *vec = vector_create_inline(4, sizeof(int), NULL);
+    void *inline_storage = vector_data(vec);
+
+    for (int i = 0; i < 4; ++i) {
+        vector_push_back(vec, &i);
+    }
+    CHECK(vector_data(vec) == inline_storage);
+
+    const int value = 4;
+    vector_push_back(vec, &value);
+    CHECK(vector_data(vec) != inline_storage && vector_size(vec) == 5);
+
+    vector_pop_back_n(vec, 2, NULL);
+    CHECK(vector_shrink_to_fit(vec));
+    CHECK(vector_data(vec) == inline_storage && *(int *)vector_back(vec) == 2);
+
+    vector_destroy(vec);
+}
+
+static void test_embedded(void) {
+    Vector vec;
+    CHECK(vector_init(&vec, 0, sizeof(int), NULL));
+
+    const int value = 5;
+    vector_push_back(&vec, &value);
+    CHECK(vector_size(&vec) == 1 && *(int *)vector_at(&vec, 0) == 5);
+    vector_deinit(&vec);
+
+    int buf[2];
+    vector_init_in_place(&vec, buf, 2, sizeof(int), NULL);
+    for (int i = 0; i < 3; ++i) {
+        vector_push_back(&vec, &i);
+    }
+    CHECK(vector_data(&vec) != buf && *(int *)vector_at(&vec, 2) == 2);
+    vector_deinit(&vec);
+}
+
+static void test_define(void) {
+    IntVector vec;
+    CHECK(IntVector_init(&vec, 0, NULL));
+
+    for (int i = 0; i < 100; ++i) {
+        IntVector_push_back(&vec, i * 2);
+    }
+
+    CHECK(IntVector_size(&vec) == 100 && IntVector_get(&vec, 50) == 100);
+    CHECK(IntVector_insert(&vec, 0, -1) && *IntVector_at(&vec, 0) == -1);
+    CHECK(IntVector_pop_back(&vec) == 198);
+    CHECK(IntVector_end(&vec) - IntVector_begin(&vec) == 100);
+
+    IntVector_deinit(&vec);
+}
+
+static void test_emplace(void) {
+    Vector *vec = vector_create(0, sizeof(int), NULL);
+
+    *(int *)vector_emplace_back(vec) = 1;
+
+    int *run = (int *)vector_push_uninit(vec, 3);
+    CHECK(run);
+    for (int i = 0; i < 3; ++i) {
+        run[i] = i + 2;
+    }
+
+    *(int *)vector_emplace_at(vec, 0) = 0;
+
+    const int expected[5] = {0, 1, 2, 3, 4};
+    CHECK(ints_are(vec, expected, 5));
+
+    vector_destroy(vec);
+}
+
+static void test_remove(void) {
+    destroyed = 0;
+
+    Vector *vec = make_ints(10, count_destructor);
+    CHECK(vector_swap_remove(vec, 2) && destroyed == 1);
+    CHECK(*(int *)vector_at(vec, 2) == 9 && vector_size(vec) == 9);
+
+    CHECK(vector_remove_if(vec, is_odd, NULL) == 5 && destroyed == 6);
+
+    const int evens[4] = {0, 4, 6, 8};
+    CHECK(ints_are(vec, evens, 4));
+    vector_destroy(vec);
+
+    destroyed = 0;
+    vec = make_ints(1000, count_destructor);
+    CHECK(vector_remove_if_unordered(vec, is_odd, NULL) == 500 && destroyed == 500);
+
+    long long sum = 0;
+    bool even = true;
+    for (size_t i = 0; i < vector_size(vec); ++i) {
+        const int value = *(int *)vector_at(vec, i);
+        sum += value;
+        even = even && !(value & 1);
+    }
+    CHECK(even && sum == 249500);
+
+    vector_destroy(vec);
+}
+
+static void test_sort(void) {
+    const VectorOrder by_key = {VECTOR_KEY_I32, offsetof(TestPair, key), NULL};
+    Vector *vec = vector_create(0, sizeof(TestPair), NULL);
+
+    for (int32_t i = 0; i < 1000; ++i) {
+        const TestPair pair = {(i * 7919) % 101 - 50, i};
+        vector_push_back(vec, &pair);
+    }
+
+    CHECK(vector_sort(vec, &by_key));
+
+    bool sorted = true;
+    for (size_t i = 1; i < vector_size(vec); ++i) {
+        const TestPair *prev = (const TestPair *)vector_at(vec, i - 1);
+        const TestPair *cur = (const TestPair *)vector_at(vec, i);
+        /* Radix sort is stable: equal keys keep their insertion order. */
+        sorted = sorted && (prev->key < cur->key || (prev->key == cur->key && prev->order < cur->order));
+    }
+    CHECK(sorted);
+
+    const int32_t probe = -3;
+    size_t idx = 0;
+    CHECK(vector_binary_search(vec, &probe, &by_key, &idx));
+    CHECK(idx == vector_lower_bound(vec, &probe, &by_key));
+    CHECK(((TestPair *)vector_at(vec, idx))->key == -3 && ((TestPair *)vector_at(vec, idx - 1))->key == -4);
+
+    const int32_t missing = 51;
+    CHECK(!vector_binary_search(vec, &missing, &by_key, NULL));
+    CHECK(vector_lower_bound(vec, &missing, &by_key) == vector_size(vec));
+
+    const TestPair extra = {-3, 1000};
+    TestPair *placed = (TestPair *)vector_insert_sorted(vec, &extra, &by_key);
+    CHECK(placed && placed->order == 1000 && placed[1].key == -2);
+
+    const VectorOrder desc = {VECTOR_KEY_NONE, 0, compare_pairs_desc};
+    CHECK(vector_sort(vec, &desc));
+    CHECK(((TestPair *)vector_front(vec))->key == 50 && ((TestPair *)vector_back(vec))->key == -50);
+
+    vector_destroy(vec);
+}
+
+static void test_aligned(void) {
+    Vector *vec = vector_create_aligned(1, sizeof(double), 64, NULL);
+
+    CHECK(vec && (uintptr_t)vec % 64 == 0);
+    CHECK((uintptr_t)vector_data(vec) % 64 == 0);
+
+    for (int i = 0; i < 1000; ++i) {
+        const double value = i;
+        vector_push_back(vec, &value);
+    }
+    CHECK((uintptr_t)vector_data(vec) % 64 == 0);
+
+    vector_pop_back_n(vec, 990, NULL);
+    vector_shrink_to_fit(vec);
+    CHECK((uintptr_t)vector_data(vec) % 64 == 0 && *(double *)vector_back(vec) == 9.0);
+
+    Vector *copy = vector_clone(vec);
+    CHECK(copy && (uintptr_t)vector_data(copy) % 64 == 0 && vector_size(copy) == 10);
+
+    vector_destroy(copy);
+    vector_destroy(vec);
+}
+
+static void test_range_destructor(void) {
+    destroyed = 0;
+    range_calls = 0;
+
+    Vector *vec = make_ints(100, count_destructor);
+    vector_set_range_destructor(vec, count_range);
+
+    CHECK(vector_erase_range(vec, 10, 20) && range_calls == 1 && destroyed == 20);
+    CHECK(vector_pop_back_n(vec, 5, NULL) && range_calls == 2 && destroyed == 25);
+
+    vector_destroy(vec);
+    CHECK(range_calls == 3 && destroyed == 100);
+}
+
+static void test_reserved(void) {
+    Vector *vec = vector_create_reserved(100000, sizeof(int), NULL);
+    CHECK(vec);
+
+    int value = 0;
+    vector_push_back(vec, &value);
+    const int *first = (const int *)vector_data(vec);
+
+    for (value = 1; value < 50000; ++value) {
+        vector_push_back(vec, &value);
+    }
+    /* Growth within the reservation commits pages in place. */
+    CHECK(vector_data(vec) == first && *(int *)vector_at(vec, 49999) == 49999);
+
+    vector_pop_back_n(vec, 49000, NULL);
+    CHECK(vector_shrink_to_fit(vec) && vector_data(vec) == first && *(int *)vector_back(vec) == 999);
+
+    Vector *copy = vector_clone(vec);
+    CHECK(copy && vector_equal(copy, vec));
+
+    vector_destroy(copy);
+    vector_destroy(vec);
+}
+
+static void test_persist(void) {
+    Vector *vec = make_ints(1000, NULL);
+    FILE *file = tmpfile();
+    CHECK(file && vector_write(vec, file));
+    if (NULL == file) {
+        vector_destroy(vec);
+        return;
+    }
+
+    rewind(file);
+    Vector *copy = vector_read(file, NULL);
+    CHECK(copy && vector_equal(copy, vec));
+    vector_destroy(copy);
+
+    /* A corrupt count must fail at end of file, not allocate what it claims. */
+    const uint64_t huge = UINT64_C(1) << 40;
+    fseek(file, 24, SEEK_SET);
+    fwrite(&huge, sizeof(huge), 1, file);
+    rewind(file);
+    CHECK(NULL == vector_read(file, count_destructor));
+
+    fclose(file);
+    vector_destroy(vec);
+}
+
+static void test_mapped_mutators(void) {
+    const char *path = "test_vector_map.bin";
+    Vector *vec = make_ints(100, NULL);
+
+    FILE *file = fopen(path, "wb");
+    CHECK(file && vector_write(vec, file));
+    if (file) {
+        fclose(file);
+    }
+
+    Vector *mapped = vector_map_file(path, true);
+    CHECK(mapped);
+    if (NULL == mapped) {
+        vector_destroy(vec);
+        return;
+    }
+
+    const int value = 7;
+    CHECK(!vector_erase(mapped, 0));
+    CHECK(!vector_erase_range(mapped, 0, 2));
+    CHECK(!vector_swap_remove(mapped, 0));
+    CHECK(vector_remove_if(mapped, is_odd, NULL) == 0);
+    CHECK(!vector_sort(mapped, &(VectorOrder){VECTOR_KEY_I32, 0, NULL}));
+    CHECK(!vector_insert(mapped, 0, &value));
+    CHECK(!vector_push_back(mapped, &value));
+    CHECK(!vector_push_front(mapped, &value));
+    CHECK(!vector_at_mut(mapped, 0) && !vector_data_mut(mapped));
+    vector_fill(mapped, 0, 10, &value);
+    CHECK(vector_try_push_back(mapped, &value) == VECTOR_UNSUPPORTED);
+    CHECK(vector_try_erase(mapped, 0) == VECTOR_UNSUPPORTED);
+    CHECK(vector_equal(mapped, vec));
+
+    /* Popping only shrinks the view. */
+    CHECK(vector_pop_back_n(mapped, 1, NULL) && vector_size(mapped) == 99);
+
+    Vector *copy = vector_clone(mapped);
+    CHECK(copy && vector_push_back(copy, &value) && vector_size(copy) == 100);
+
+    vector_destroy(copy);
+    vector_destroy(mapped);
+    vector_destroy(vec);
+    remove(path);
+}
+
+static void test_cow_plain(void) {
+    Vector *vec = make_ints(10, NULL);
+    Vector *copy = vector_clone_cow(vec);
+
+    CHECK(copy && vector_data(copy) == vector_data(vec));
+
+    const int value = -1;
+    CHECK(vector_push_back(copy, &value));
+    CHECK(vector_data(copy) != vector_data(vec));
+    CHECK(vector_size(vec) == 10 && vector_size(copy) == 11);
+
+    Vector *other = vector_clone_cow(vec);
+    CHECK(vector_erase(other, 0));
+    CHECK(*(int *)vector_at(vec, 0) == 0 && *(int *)vector_at(other, 0) == 1);
+
+    Vector *last = vector_clone_cow(vec);
+    *(int *)vector_at_mut(last, 0) = 42;
+    CHECK(*(int *)vector_at(vec, 0) == 0 && *(int *)vector_at(last, 0) == 42);
+
+    vector_destroy(vec);
+    vector_destroy(copy);
+    vector_destroy(other);
+    vector_destroy(last);
+}
+
+static void test_cow_destructor(void) {
+    destroyed = 0;
+
+    Vector *vec = make_ints(4, count_destructor);
+    Vector *copy = vector_clone_cow(vec);
+
+    /* Owned elements are never shared. */
+    CHECK(copy && vector_data(copy) != vector_data(vec));
+
+    const int value = 4;
+    vector_push_back(copy, &value);
+    CHECK(vector_erase(vec, 0) && destroyed == 1);
+    CHECK(*(int *)vector_at(copy, 0) == 0);
+
+    vector_destroy(vec);
+    vector_destroy(copy);
+    CHECK(destroyed == 4 + 5);
+}
+
+static void test_clone_deep(void) {
+    destroyed = 0;
+
+    Vector *vec = make_ints(100, count_destructor);
+    Vector *copy = vector_clone_deep(vec, copy_int, NULL);
+    CHECK(copy && vector_equal(copy, vec) && vector_data(copy) != vector_data(vec));
+    vector_destroy(copy);
+    CHECK(destroyed == 100);
+
+    /* The 50 elements copied before the failure are destroyed again. */
+    fail_at = 50;
+    CHECK(NULL == vector_clone_deep(vec, copy_int, NULL));
+    CHECK(destroyed == 150);
+    fail_at = -1;
+
+    copy = vector_clone_deep_range(vec, copy_ints, NULL);
+    CHECK(copy && vector_equal(copy, vec));
+
+    vector_destroy(copy);
+    vector_destroy(vec);
+}
+
+static void test_front_fifo(void) {
+    Vector *queue = vector_create(4, sizeof(int), NULL);
+    int next_in = 0;
+    int next_out = 0;
+    bool ordered = true;
+
+    for (int round = 0; round < 1000; ++round) {
+        for (int i = 0; i < 3; ++i, ++next_in) {
+            vector_push_back(queue, &next_in);
+        }
+
+        for (int i = 0; i < 2; ++i, ++next_out) {
+            int out = -1;
+            ordered = ordered && vector_pop_front(queue, &out) && out == next_out;
+        }
+    }
+
+    CHECK(ordered);
+    CHECK(vector_size(queue) == (size_t)(next_in - next_out));
+    CHECK(*(int *)vector_front(queue) == next_out);
+    /* Amortized O(1): the front slack is reused instead of growing forever. */
+    CHECK(vector_capacity(queue) < 4 * vector_size(queue) + 16);
+
+    for (int i = 0; i < 10; ++i) {
+        vector_push_front(queue, &i);
+    }
+    CHECK(*(int *)vector_front(queue) == 9);
+
+    int *data = (int *)vector_linearize(queue);
+    CHECK(data && data[0] == 9 && data[10] == next_out);
+
+    vector_destroy(queue);
+}
+
+static void test_thread_cache(void) {
+    vector_thread_cache_set_limit(1 << 20);
+
+    /* A spilled inline vector has a bigger header than the cache hands out. */
+    Vector *small = vector_create_inline(4, sizeof(int), NULL);
+    for (int i = 0; i < 64; ++i) {
+        vector_push_back(small, &i);
+    }
+    vector_destroy(small);
+    CHECK(vector_thread_cache_bytes() == 0);
+
+    Vector *vec = vector_create(64, sizeof(int), NULL);
+    void *storage = vector_data(vec);
+    vector_destroy(vec);
+    CHECK(vector_thread_cache_bytes() > 0);
+
+    vec = vector_create(64, sizeof(int), NULL);
+    CHECK(vector_data(vec) == storage && vector_thread_cache_bytes() == 0);
+    vector_destroy(vec);
+
+    vector_thread_cache_set_limit(0);
+    CHECK(vector_thread_cache_bytes() == 0);
+}
+
+static void test_large_clone(void) {
+    /* Big enough for the streaming copy when built with VECTOR_STREAM_THRESHOLD. */
+    Vector *vec = make_ints(1 << 20, NULL);
+    vector_prefetch_range(vec, 0, vector_size(vec));
+
+    Vector *copy = vector_clone(vec);
+    CHECK(copy && vector_equal(copy, vec));
+
+    vector_destroy(copy);
+    vector_destroy(vec);
+}
+
+static void test_try(void) {
+    Vector *vec = vector_create(2, sizeof(int), NULL);
+    int out = 0;
+    void *slot = NULL;
+
+    CHECK(vector_try_pop_back(vec, &out) == VECTOR_OUT_OF_RANGE);
+    CHECK(vector_try_at(vec, 0, &slot) == VECTOR_OUT_OF_RANGE);
+    CHECK(vector_try_insert(vec, 1, &out) == VECTOR_OUT_OF_RANGE);
+    CHECK(vector_try_push_back(vec, &out) == VECTOR_OK);
+    CHECK(vector_try_reserve(vec, 1) == VECTOR_OK);
+    CHECK(vector_try_reserve(vec, SIZE_MAX / 2) == VECTOR_OVERFLOW);
+    CHECK(vector_try_at(vec, 0, &slot) == VECTOR_OK && slot == vector_at_unchecked(vec, 0));
+
+    vector_destroy(vec);
+}
+
+#ifdef VECTOR_STATS
+static size_t growths;
+
+static void count_growth(const Vector *vec, size_t old_capacity, size_t new_capacity, void *ctx) {
+    (void)vec;
+
+    growths += new_capacity > old_capacity && ctx == &growths;
+
+    return;
+}
+
+static void find_label(const Vector *vec, const VectorStats *stats, void *ctx) {
+    (void)vec;
+
+    if (stats->label && strcmp(stats->label, "test_stats") == 0) {
+        *(size_t *)ctx = stats->peak_capacity;
+    }
+
+    return;
+}
+
+static void test_stats(void) {
+    growths = 0;
+    vector_stats_set_growth_hook(count_growth, &growths);
+
+    Vector *vec = vector_create(1, sizeof(int), NULL);
+    vector_stats_set_label(vec, "test_stats");
+    for (int i = 0; i < 100; ++i) {
+        vector_push_back(vec, &i);
+    }
+    vector_erase(vec, 0);
+
+    VectorStats stats;
+    vector_get_stats(vec, &stats);
+    CHECK(stats.reallocations > 0 && stats.reallocations == growths);
+    CHECK(stats.peak_capacity >= 100 && stats.bytes_moved == 99 * sizeof(int));
+
+    size_t peak = 0;
+    vector_stats_foreach(find_label, &peak);
+    CHECK(peak == stats.peak_capacity);
+
+    vector_stats_set_growth_hook(NULL, NULL);
+    vector_destroy(vec);
+}
+#endif /* VECTOR_STATS */
+
+int main(void) {
+    test_push_pop();
+    test_bulk();
+    test_allocator();
+    test_growth();
+    test_inline();
+    test_embedded();
+    test_define();
+    test_emplace();
+    test_remove();
+    test_sort();
+    test_aligned();
+    test_range_destructor();
+    test_reserved();
+    test_persist();
+    test_mapped_mutators();
+    test_cow_plain();
+    test_cow_destructor();
+    test_clone_deep();
+    test_front_fifo();
+    test_thread_cache();
+    test_large_clone();
+    test_try();
+#ifdef VECTOR_STATS
+    test_stats();
+#endif /* VECTOR_STATS */
+
+    return TEST_RESULT();
+}
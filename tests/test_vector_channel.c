@@ -0,0 +1,128 @@
+#include <stdint.h>
+#include <pthread.h>
+
+#include "../vector_channel.h"
+#include "test.h"
+
+#define TEST_MESSAGES 20000
+#define TEST_PRODUCERS 4
+
+typedef struct TestQueue {
+    VectorChannel *channel;
+    int first;
+    int count;
+} TestQueue;
+
+static void *test_send(void *arg) {
+    TestQueue *queue = (TestQueue *)arg;
+
+    for (int i = 0; i < queue->count; ++i) {
+        Vector *vec = vector_create(1, sizeof(int), NULL);
+        const int value = queue->first + i;
+        vector_push_back(vec, &value);
+
+        while (!vector_channel_send(queue->channel, vec)) {
+        }
+    }
+
+    return NULL;
+}
+
+static void test_spsc_order(void) {
+    TestQueue queue = {vector_channel_create(64, VECTOR_CHANNEL_SPSC), 0, TEST_MESSAGES};
+    CHECK(vector_channel_capacity(queue.channel) == 64);
+
+    pthread_t producer;
+    pthread_create(&producer, NULL, test_send, &queue);
+
+    bool ordered = true;
+    for (int expected = 0; expected < TEST_MESSAGES;) {
+        Vector *vec = vector_channel_recv(queue.channel);
+        if (vec) {
+            ordered = ordered && *(int *)vector_at(vec, 0) == expected++;
+            vector_destroy(vec);
+        }
+    }
+
+    pthread_join(producer, NULL);
+    CHECK(ordered);
+    CHECK(NULL == vector_channel_recv(queue.channel));
+
+    vector_channel_destroy(queue.channel);
+}
+
+static void test_mpmc_count(void) {
+    VectorChannel *channel = vector_channel_create(16, VECTOR_CHANNEL_MPMC);
+    TestQueue queues[TEST_PRODUCERS];
+    pthread_t producers[TEST_PRODUCERS];
+
+    for (int p = 0; p < TEST_PRODUCERS; ++p) {
+        queues[p].channel = channel;
+        queues[p].first = p * TEST_MESSAGES;
+        queues[p].count = TEST_MESSAGES;
+        pthread_create(&producers[p], NULL, test_send, &queues[p]);
+    }
+
+    long long sum = 0;
+    for (int received = 0; received < TEST_PRODUCERS * TEST_MESSAGES;) {
+        Vector *vec = vector_channel_recv(channel);
+        if (vec) {
+            sum += *(int *)vector_at(vec, 0);
+            ++received;
+            vector_destroy(vec);
+        }
+    }
+
+    for (int p = 0; p < TEST_PRODUCERS; ++p) {
+        pthread_join(producers[p], NULL);
+    }
+
+    const long long n = (long long)TEST_PRODUCERS * TEST_MESSAGES;
+    CHECK(sum == n * (n - 1) / 2);
+
+    vector_channel_destroy(channel);
+}
+
+static void test_full_and_destroy(void) {
+    VectorChannel *channel = vector_channel_create(3, VECTOR_CHANNEL_MPMC);
+    CHECK(vector_channel_capacity(channel) == 4);
+
+    for (int i = 0; i < 4; ++i) {
+        CHECK(vector_channel_send(channel, vector_create(1, 1, NULL)));
+    }
+
+    Vector *extra = vector_create(1, 1, NULL);
+    CHECK(!vector_channel_send(channel, extra));
+    vector_destroy(extra);
+
+    /* Queued vectors are destroyed with the channel. */
+    vector_channel_destroy(channel);
+}
+
+static void test_pool_reuse(void) {
+    VectorPool *pool = vector_pool_create(sizeof(int), 4, NULL, 2);
+
+    Vector *vec = vector_pool_acquire(pool);
+    for (int i = 0; i < 100; ++i) {
+        vector_push_back(vec, &i);
+    }
+
+    void *storage = vector_data(vec);
+    vector_pool_release(pool, vec);
+
+    Vector *again = vector_pool_acquire(pool);
+    CHECK(again == vec && vector_size(again) == 0);
+    CHECK(vector_data(again) == storage && vector_capacity(again) >= 100);
+
+    vector_pool_release(pool, again);
+    vector_pool_destroy(pool);
+}
+
+int main(void) {
+    test_spsc_order();
+    test_mpmc_count();
+    test_full_and_destroy();
+    test_pool_reuse();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,180 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "../vector_parallel.h"
+#include "test.h"
+
+#define TEST_COUNT 100000
+
+static unsigned char visited[TEST_COUNT];
+
+static void visit(size_t idx, void *ctx) {
+    (void)ctx;
+
+    ++visited[idx];
+
+    return;
+}
+
+static void add_index(void *elem, size_t idx, void *ctx) {
+    (void)ctx;
+
+    *(int *)elem += (int)idx;
+
+    return;
+}
+
+static void sum_elem(void *acc, const void *elem, size_t idx, void *ctx) {
+    (void)idx;
+    (void)ctx;
+
+    *(long long *)acc += *(const int *)elem;
+
+    return;
+}
+
+static void sum_merge(void *acc, const void *other, void *ctx) {
+    (void)ctx;
+
+    *(long long *)acc += *(const long long *)other;
+
+    return;
+}
+
+static void mark_destroyed(void *elem) {
+    ++visited[*(int *)elem];
+
+    return;
+}
+
+static bool all_visited_once(void) {
+    bool once = true;
+    for (size_t i = 0; i < TEST_COUNT; ++i) {
+        once = once && visited[i] == 1;
+    }
+
+    return once;
+}
+
+static bool copy_ints(void *dst, const void *src, const size_t count, void *ctx) {
+    const int *fail = (const int *)ctx;
+    const int *first = (const int *)src;
+
+    if (fail && *fail >= first[0] && *fail <= first[count - 1]) {
+        return false;
+    }
+
+    memcpy(dst, src, count * sizeof(int));
+
+    return true;
+}
+
+static size_t executor_runs;
+
+static void serial_run(void *ctx, size_t n_tasks, void (*task)(size_t idx, void *task_ctx), void *task_ctx) {
+    ++*(size_t *)ctx;
+
+    for (size_t i = 0; i < n_tasks; ++i) {
+        task(i, task_ctx);
+    }
+
+    return;
+}
+
+static Vector *make_ints(const int count, void (*destructor)(void *)) {
+    Vector *vec = vector_create(count, sizeof(int), destructor);
+
+    for (int i = 0; i < count; ++i) {
+        vector_push_back(vec, &i);
+    }
+
+    return vec;
+}
+
+static void test_run(void) {
+    memset(visited, 0, sizeof(visited));
+    vector_parallel_run(TEST_COUNT, visit, NULL);
+    CHECK(all_visited_once());
+}
+
+static void test_for_reduce(void) {
+    Vector *vec = make_ints(TEST_COUNT, NULL);
+
+    /* Element i becomes 2 * i. */
+    vector_parallel_for(vec, 0, add_index, NULL);
+
+    long long sum = 0;
+    CHECK(vector_parallel_reduce(vec, 1000, &sum, sizeof(sum), sum_elem, sum_merge, NULL));
+    CHECK(sum == (long long)TEST_COUNT * (TEST_COUNT - 1));
+
+    long long small = 0;
+    Vector *few = make_ints(3, NULL);
+    CHECK(vector_parallel_reduce(few, 0, &small, sizeof(small), sum_elem, sum_merge, NULL) && small == 3);
+
+    vector_destroy(few);
+    vector_destroy(vec);
+}
+
+static void test_clear_destroy(void) {
+    Vector *vec = make_ints(TEST_COUNT, mark_destroyed);
+
+    memset(visited, 0, sizeof(visited));
+    vector_parallel_clear(vec, 0);
+    CHECK(vector_size(vec) == 0 && all_visited_once());
+
+    for (int i = 0; i < TEST_COUNT; ++i) {
+        vector_push_back(vec, &i);
+    }
+    memset(visited, 0, sizeof(visited));
+    vector_parallel_destroy(vec, 1000);
+    CHECK(all_visited_once());
+
+    memset(visited, 0, sizeof(visited));
+    vector_destroy_async(make_ints(TEST_COUNT, mark_destroyed));
+    vector_destroy_async_wait();
+    CHECK(all_visited_once());
+}
+
+static void test_clone_deep(void) {
+    Vector *vec = make_ints(TEST_COUNT, mark_destroyed);
+
+    Vector *copy = vector_parallel_clone_deep(vec, 1000, copy_ints, NULL);
+    CHECK(copy && vector_size(copy) == TEST_COUNT && vector_equal(copy, vec));
+    vector_destroy(copy);
+
+    copy = vector_parallel_clone(vec, 0);
+    CHECK(copy && vector_equal(copy, vec));
+    vector_destroy(copy);
+
+    /* Only the chunks that were copied are destroyed. */
+    const int fail = TEST_COUNT / 2;
+    memset(visited, 0, sizeof(visited));
+    CHECK(NULL == vector_parallel_clone_deep(vec, 1000, copy_ints, (void *)&fail));
+
+    bool once = visited[fail] == 0;
+    for (size_t i = 0; i < TEST_COUNT; ++i) {
+        once = once && visited[i] <= 1;
+    }
+    CHECK(once);
+
+    vector_destroy(vec);
+}
+
+int main(void) {
+    CHECK(vector_parallel_init(4));
+
+    test_run();
+    test_for_reduce();
+    test_clear_destroy();
+    test_clone_deep();
+
+    vector_parallel_shutdown();
+
+    const VectorExecutor executor = {serial_run, &executor_runs};
+    vector_parallel_set_executor(&executor);
+    test_for_reduce();
+    CHECK(executor_runs > 0);
+    vector_parallel_set_executor(NULL);
+
+    return TEST_RESULT();
+}
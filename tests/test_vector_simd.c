@@ -0,0 +1,85 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "../vector.h"
+#include "test.h"
+
+static const size_t elem_sizes[5] = {1, 2, 4, 8, 12};
+
+/* Element i of the test vectors: its bytes are (i * 3 + k) & 0x7f, never 0xff. */
+static void make_elem(unsigned char *elem, const size_t elem_size, const size_t idx) {
+    for (size_t k = 0; k < elem_size; ++k) {
+        elem[k] = (unsigned char)((idx * 3 + k) & 0x7f);
+    }
+
+    return;
+}
+
+static Vector *make_vector(const size_t elem_size, const size_t count) {
+    Vector *vec = vector_create(count, elem_size, NULL);
+    unsigned char elem[16];
+
+    for (size_t i = 0; i < count; ++i) {
+        make_elem(elem, elem_size, i);
+        vector_push_back(vec, elem);
+    }
+
+    return vec;
+}
+
+static void test_find_count(void) {
+    unsigned char probe[16];
+    memset(probe, 0xff, sizeof(probe));
+
+    for (size_t s = 0; s < sizeof(elem_sizes) / sizeof(elem_sizes[0]); ++s) {
+        const size_t elem_size = elem_sizes[s];
+
+        /* Lengths around every vector width, and a long one. */
+        for (size_t count = 0; count <= 70; count += count < 40 ? 1 : 15) {
+            Vector *vec = make_vector(elem_size, count);
+            bool found = vector_find(vec, probe) == count && !vector_contains(vec, probe);
+
+            for (size_t at = 0; at < count; ++at) {
+                void *slot = vector_at(vec, at);
+                unsigned char saved[16];
+                memcpy(saved, slot, elem_size);
+                memcpy(slot, probe, elem_size);
+
+                found = found && vector_find(vec, probe) == at && vector_count(vec, probe) == 1;
+                memcpy(slot, saved, elem_size);
+            }
+
+            CHECK(found);
+            vector_destroy(vec);
+        }
+    }
+}
+
+static void test_fill_equal(void) {
+    for (size_t s = 0; s < sizeof(elem_sizes) / sizeof(elem_sizes[0]); ++s) {
+        const size_t elem_size = elem_sizes[s];
+        Vector *vec = make_vector(elem_size, 1000);
+        Vector *copy = vector_clone(vec);
+        unsigned char value[16];
+        memset(value, 0xff, sizeof(value));
+
+        CHECK(vector_equal(vec, copy));
+
+        vector_fill(vec, 3, 997, value);
+        CHECK(vector_count(vec, value) == 997 && vector_find(vec, value) == 3);
+        CHECK(!vector_equal(vec, copy));
+
+        vector_fill(copy, 3, 997, value);
+        CHECK(vector_equal(vec, copy));
+
+        vector_destroy(copy);
+        vector_destroy(vec);
+    }
+}
+
+int main(void) {
+    test_find_count();
+    test_fill_equal();
+
+    return TEST_RESULT();
+}
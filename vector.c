@@ -1,259 +1,2583 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif /* __linux__ */
+
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdint.h>
 
+#define VECTOR_BUILD
 #include "vector.h"
-
-struct Vector {
-    void *value;
-    size_t elem_size;
-    size_t elem_count;
-    size_t capacity;
-    void (*destructor)(void *);
+#include "vector_internal.h"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#define VECTOR_HAVE_USABLE_SIZE
+#endif /* __GLIBC__ */
+
+#if defined(_WIN32)
+#include <windows.h>
+#define VECTOR_HAVE_VM
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define VECTOR_HAVE_VM
+#endif /* _WIN32 */
+
+/* Storage currently lives in the inline buffer rather than on the heap. */
+#define VECTOR_FLAG_INLINE (1u << 0)
+/* Header is owned by the caller (vector_init). */
+#define VECTOR_FLAG_EMBEDDED (1u << 1)
+/* Header was allocated cache-line aligned and padded (vector_create_aligned). */
+#define VECTOR_FLAG_ALIGNED_HEADER (1u << 2)
+/* Storage is a reserved virtual address range committed on demand (vector_create_reserved). */
+#define VECTOR_FLAG_VM (1u << 3)
+/* Storage is a read-only view into a mapped file (vector_map_file). */
+#define VECTOR_FLAG_MAPPED (1u << 4)
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VECTOR_HAVE_STREAM
+#endif
+
+/*
+ * Defining VECTOR_STREAM_THRESHOLD makes copies of at least that many
+ * bytes bypass the cache with non-temporal stores. Off by default:
+ * glibc's memcpy already streams copies larger than the shared cache
+ * and is faster at it, while streaming smaller copies loses the
+ * benefit of the destination staying cached.
+ */
+#if defined(VECTOR_STREAM_THRESHOLD) && !defined(VECTOR_HAVE_STREAM)
+#undef VECTOR_STREAM_THRESHOLD
+#endif
+
+/* How far ahead of the copy the source is prefetched. */
+#define VECTOR_PREFETCH_DISTANCE 512
+
+#if defined(__GNUC__) || defined(__clang__)
+#define VECTOR_PREFETCH(ptr) __builtin_prefetch((ptr), 0, 3)
+#elif defined(VECTOR_HAVE_STREAM)
+#define VECTOR_PREFETCH(ptr) _mm_prefetch((const char *)(ptr), _MM_HINT_T0)
+#else
+#define VECTOR_PREFETCH(ptr) ((void)(ptr))
+#endif
+
+/* Size classes of the thread cache: bin k holds storage of [2^k, 2^(k+1)) bytes. */
+#define VECTOR_CACHE_BINS (sizeof(size_t) * 8)
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define VECTOR_REF_ACQUIRE(refs) _InterlockedIncrement(refs)
+#define VECTOR_REF_RELEASE(refs) _InterlockedDecrement(refs)
+#define VECTOR_REF_LOAD(refs) _InterlockedOr(refs, 0)
+#else
+#define VECTOR_REF_ACQUIRE(refs) __atomic_add_fetch(refs, 1, __ATOMIC_RELAXED)
+#define VECTOR_REF_RELEASE(refs) __atomic_sub_fetch(refs, 1, __ATOMIC_ACQ_REL)
+#define VECTOR_REF_LOAD(refs) __atomic_load_n(refs, __ATOMIC_ACQUIRE)
+#endif /* _MSC_VER */
+
+/* Control block of storage shared by vector_clone_cow. */
+struct VectorShared {
+    long refs;
 };
 
-Vector *vector_create(const size_t capacity, const size_t elem_size, void (*destructor)(void *)) {
-    assert(elem_size > 0);
-    
-    Vector *vec = (Vector *)malloc(sizeof(struct Vector));
-    if (NULL == vec) {
-        return NULL;
+#ifdef VECTOR_STATS
+#if defined(_WIN32)
+#include <windows.h>
+static SRWLOCK vector_registry_lock = SRWLOCK_INIT;
+#define VECTOR_REGISTRY_LOCK() AcquireSRWLockExclusive(&vector_registry_lock)
+#define VECTOR_REGISTRY_UNLOCK() ReleaseSRWLockExclusive(&vector_registry_lock)
+#else
+#include <pthread.h>
+static pthread_mutex_t vector_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+#define VECTOR_REGISTRY_LOCK() pthread_mutex_lock(&vector_registry_lock)
+#define VECTOR_REGISTRY_UNLOCK() pthread_mutex_unlock(&vector_registry_lock)
+#endif /* _WIN32 */
+
+static Vector *vector_registry;
+static VectorGrowthHook vector_growth_hook;
+static void *vector_growth_hook_ctx;
+
+static void vector_stats_register(Vector *vec) {
+    memset(&vec->stats, 0, sizeof(vec->stats));
+    vec->stats.peak_capacity = vec->capacity;
+
+    VECTOR_REGISTRY_LOCK();
+    vec->stats_prev = NULL;
+    vec->stats_next = vector_registry;
+    if (vector_registry) {
+        vector_registry->stats_prev = vec;
     }
+    vector_registry = vec;
+    VECTOR_REGISTRY_UNLOCK();
 
-    vec->capacity = capacity == 0 ? 1 : capacity;
-    vec->elem_size = elem_size;
-    vec->elem_count = 0;
-    vec->destructor = destructor == NULL ? NULL : destructor;
+    return;
+}
 
-    vec->value = malloc(vec->capacity * vec->elem_size);
-    if (NULL == vec->value) {
-        free(vec);
-        return NULL;
+static void vector_stats_unregister(Vector *vec) {
+    VECTOR_REGISTRY_LOCK();
+    if (vec->stats_prev) {
+        vec->stats_prev->stats_next = vec->stats_next;
+    } else {
+        vector_registry = vec->stats_next;
+    }
+    if (vec->stats_next) {
+        vec->stats_next->stats_prev = vec->stats_prev;
     }
+    VECTOR_REGISTRY_UNLOCK();
 
-    return vec;
+    return;
 }
 
-void vector_destroy(Vector *vec) {
-    assert(vec);
+static void vector_stats_resized(Vector *vec, const size_t old_capacity) {
+    ++vec->stats.reallocations;
 
-    if (vec->destructor) {
-        for (char *ptr = vec->value;
-             ptr < (char *)vec->value + vec->elem_count * vec->elem_size;
-             ptr += vec->elem_size) {
-            vec->destructor(ptr);
-        }
+    if (vec->capacity > vec->stats.peak_capacity) {
+        vec->stats.peak_capacity = vec->capacity;
     }
 
-    free(vec->value);
-    free(vec);
+    if (vec->capacity > old_capacity) {
+        /* Read hook and ctx together, but call the hook unlocked: it may create vectors. */
+        VECTOR_REGISTRY_LOCK();
+        const VectorGrowthHook hook = vector_growth_hook;
+        void *ctx = vector_growth_hook_ctx;
+        VECTOR_REGISTRY_UNLOCK();
+
+        if (hook) {
+            hook(vec, old_capacity, vec->capacity, ctx);
+        }
+    }
 
     return;
 }
 
-void vector_reset(Vector *vec) {
-    assert(vec);
+#define VECTOR_STATS_REGISTER(vec) vector_stats_register(vec)
+#define VECTOR_STATS_UNREGISTER(vec) vector_stats_unregister(vec)
+#define VECTOR_STATS_RESIZED(vec, old_capacity) vector_stats_resized(vec, old_capacity)
+#define VECTOR_STATS_MOVED(vec, bytes) ((vec)->stats.bytes_moved += (bytes))
+#else
+#define VECTOR_STATS_REGISTER(vec) ((void)0)
+#define VECTOR_STATS_UNREGISTER(vec) ((void)0)
+#define VECTOR_STATS_RESIZED(vec, old_capacity) ((void)0)
+#define VECTOR_STATS_MOVED(vec, bytes) ((void)0)
+#endif /* VECTOR_STATS */
 
-    vec->elem_count = 0;
+/* Header size, padded so that inline storage placed after it is suitably aligned. */
+#define VECTOR_HEADER_SIZE ((sizeof(struct Vector) + 15) & ~(size_t)15)
+
+static void *vector_default_allocate(void *ctx, const size_t size) {
+    (void)ctx;
+
+    return malloc(size);
+}
+
+static void *vector_default_reallocate(void *ctx, void *ptr, const size_t old_size, const size_t new_size) {
+    (void)ctx;
+    (void)old_size;
+
+    return realloc(ptr, new_size);
+}
+
+static void vector_default_deallocate(void *ctx, void *ptr, const size_t size) {
+    (void)ctx;
+    (void)size;
+
+    free(ptr);
 
     return;
 }
 
-void vector_clear(Vector *vec) {
-    assert(vec);
+const VectorAllocator vector_default_allocator = {
+    vector_default_allocate,
+    vector_default_reallocate,
+    vector_default_deallocate,
+    NULL
+};
 
-    if (vec->destructor) {
-        for (char *ptr = vec->value;
-             ptr < (char *)vec->value + vec->elem_count * vec->elem_size;
-             ptr += vec->elem_size) {
-            vec->destructor(ptr);
+/* memcpy, except that copies above VECTOR_STREAM_THRESHOLD stream past the cache. */
+static void vector_copy(void *dst, const void *src, const size_t bytes) {
+#ifdef VECTOR_STREAM_THRESHOLD
+    if (bytes >= (size_t)(VECTOR_STREAM_THRESHOLD)) {
+        char *out = (char *)dst;
+        const char *in = (const char *)src;
+        const size_t lead = (16 - ((uintptr_t)out & 15)) & 15;
+
+        memcpy(out, in, lead);
+        out += lead;
+        in += lead;
+
+        size_t left = bytes - lead;
+        for (; left >= 64; left -= 64, out += 64, in += 64) {
+            _mm_prefetch(in + VECTOR_PREFETCH_DISTANCE, _MM_HINT_NTA);
+
+            const __m128i a = _mm_loadu_si128((const __m128i *)in);
+            const __m128i b = _mm_loadu_si128((const __m128i *)(in + 16));
+            const __m128i c = _mm_loadu_si128((const __m128i *)(in + 32));
+            const __m128i d = _mm_loadu_si128((const __m128i *)(in + 48));
+
+            _mm_stream_si128((__m128i *)out, a);
+            _mm_stream_si128((__m128i *)(out + 16), b);
+            _mm_stream_si128((__m128i *)(out + 32), c);
+            _mm_stream_si128((__m128i *)(out + 48), d);
         }
+
+        _mm_sfence();
+        memcpy(out, in, left);
+        return;
     }
+#endif /* VECTOR_STREAM_THRESHOLD */
 
-    vector_reset(vec);
+    memcpy(dst, src, bytes);
 
     return;
 }
 
-void *vector_push_back(Vector *vec, const void *elem) {
-    assert(vec && elem);
+static void *vector_mem_realloc(const VectorAllocator *allocator, void *ptr, const size_t old_size, const size_t new_size) {
+    if (allocator->reallocate) {
+        return allocator->reallocate(allocator->ctx, ptr, old_size, new_size);
+    }
 
-    if (vec->elem_count >= vec->capacity) {
-        if (!vector_reserve(vec, (vec->capacity * 2))) {
-            return NULL;
-        }
+    void *res = allocator->allocate(allocator->ctx, new_size);
+    if (NULL == res) {
+        return NULL;
     }
 
-    memcpy((char *)vec->value + vec->elem_count * vec->elem_size, elem, vec->elem_size);
+    vector_copy(res, ptr, old_size < new_size ? old_size : new_size);
 
-    ++vec->elem_count;
+    if (allocator->deallocate) {
+        allocator->deallocate(allocator->ctx, ptr, old_size);
+    }
 
-    return ((char *)vec->value + ((vec->elem_count - 1) * vec->elem_size));
+    return res;
 }
 
-bool vector_pop_back(Vector *vec, void **out) {
-    assert(vec && out && vec->elem_count);
+/* Over-allocate and stash the raw pointer just below the aligned block. */
+static void *vector_mem_alloc_aligned(const VectorAllocator *allocator, const size_t size, const size_t alignment) {
+    const size_t overhead = alignment - 1 + sizeof(void *);
+    if (size > SIZE_MAX - overhead) {
+        return NULL;
+    }
 
-    --vec->elem_count;    
+    char *raw = (char *)vector_mem_alloc(allocator, size + overhead);
+    if (NULL == raw) {
+        return NULL;
+    }
 
-    memcpy(out, (char *)vec->value + (vec->elem_count * vec->elem_size), vec->elem_size);
-    
-    return true;
+    const uintptr_t addr = ((uintptr_t)(raw + sizeof(void *)) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    char *aligned = (char *)addr;
+    memcpy(aligned - sizeof(void *), &raw, sizeof(raw));
+
+    return aligned;
 }
 
-void *vector_at(const Vector *vec, const size_t idx) {
-    assert(vec);
-    assert(idx < vec->elem_count);
-    
-    return ((char *)vec->value + (idx * vec->elem_size));
+static void vector_mem_free_aligned(const VectorAllocator *allocator, void *ptr, const size_t size, const size_t alignment) {
+    char *raw = NULL;
+    memcpy(&raw, (char *)ptr - sizeof(void *), sizeof(raw));
+
+    vector_mem_free(allocator, raw, size + alignment - 1 + sizeof(void *));
+
+    return;
 }
 
-bool vector_reserve(Vector *vec, const size_t capacity) {
-    assert(vec);
+static const VectorGrowthPolicy vector_default_growth = {
+    VECTOR_GROWTH_DOUBLE, 0, 0, false, NULL, NULL
+};
 
-    if (capacity <= vec->capacity) {
+static size_t vector_size_class(const size_t bytes) {
+    if (bytes <= 16) {
+        return 16;
+    }
+
+    if (bytes <= 128) {
+        return (bytes + 15) & ~(size_t)15;
+    }
+
+    /* Four classes per power of two, as in jemalloc/tcmalloc. */
+    size_t shift = 0;
+    while (((bytes - 1) >> shift) > 1) {
+        ++shift;
+    }
+    shift -= 2;
+
+    const size_t mask = ((size_t)1 << shift) - 1;
+    if (bytes > SIZE_MAX - mask) {
+        return bytes;
+    }
+
+    return (bytes + mask) & ~mask;
+}
+
+static size_t vector_next_capacity(const Vector *vec, const size_t required) {
+    const VectorGrowthPolicy *policy = &vec->growth;
+    const size_t max_capacity = SIZE_MAX / vec->elem_size;
+    const size_t capacity = vec->capacity;
+    size_t step = 0;
+
+    switch (policy->kind) {
+    case VECTOR_GROWTH_DOUBLE:
+        step = capacity;
+        break;
+    case VECTOR_GROWTH_HALF:
+        step = capacity / 2;
+        break;
+    case VECTOR_GROWTH_LINEAR:
+        step = policy->increment;
+        break;
+    case VECTOR_GROWTH_CUSTOM:
+        step = 0;
+        break;
+    }
+
+    if (policy->max_step && step > policy->max_step) {
+        step = policy->max_step;
+    }
+
+    size_t new_capacity = step > max_capacity - capacity ? max_capacity : capacity + step;
+
+    if (policy->kind == VECTOR_GROWTH_CUSTOM && policy->grow) {
+        new_capacity = policy->grow(capacity, required, vec->elem_size, policy->ctx);
+        if (new_capacity > max_capacity) {
+            new_capacity = max_capacity;
+        }
+    }
+
+    if (new_capacity < required) {
+        new_capacity = required;
+    }
+
+    if (policy->round_to_size_class) {
+        new_capacity = vector_size_class(new_capacity * vec->elem_size) / vec->elem_size;
+    }
+
+    return new_capacity;
+}
+
+/* Start of the storage allocation, before any front slack. */
+static void *vector_storage_base(const Vector *vec) {
+    return (char *)vec->value - vec->head * vec->elem_size;
+}
+
+/* Forget the front slack without moving anything; only valid while vec is empty. */
+static void vector_reset_head(Vector *vec) {
+    if (vec->head == 0) {
+        return;
+    }
+
+    vec->value = vector_storage_base(vec);
+    vec->capacity += vec->head;
+    vec->head = 0;
+
+    return;
+}
+
+/* Move the elements back over the front slack. vec must own its storage. */
+static void vector_drop_slack(Vector *vec) {
+    if (vec->head == 0) {
+        return;
+    }
+
+    void *base = vector_storage_base(vec);
+
+    VECTOR_STATS_MOVED(vec, vec->elem_count * vec->elem_size);
+    memmove(base, vec->value, vec->elem_count * vec->elem_size);
+
+    vec->value = base;
+    vec->capacity += vec->head;
+    vec->head = 0;
+
+    return;
+}
+
+static bool vector_grow(Vector *vec, const size_t additional) {
+    if (additional > SIZE_MAX / vec->elem_size - vec->elem_count) {
         return false;
     }
 
-    void *res = realloc(vec->value, capacity * vec->elem_size);
-    if (NULL == res) {
-        
+    /* Reuse front slack once it is at least as big as the move costs. */
+    if (vec->head >= vec->elem_count && additional <= vec->capacity + vec->head - vec->elem_count &&
+        !(vec->flags & VECTOR_FLAG_MAPPED)) {
+        vector_drop_slack(vec);
+        return true;
+    }
+
+    if (!vector_reserve(vec, vector_next_capacity(vec, vec->elem_count + additional))) {
         return false;
     }
-    
-    vec->capacity = capacity;
-    vec->value = res;
+
+#ifdef VECTOR_HAVE_USABLE_SIZE
+    if (vec->growth.round_to_size_class && vec->allocator == &vector_default_allocator && vec->alignment == 0 &&
+        !(vec->flags & VECTOR_FLAG_VM)) {
+        vec->capacity = malloc_usable_size(vec->value) / vec->elem_size;
+    }
+#endif /* VECTOR_HAVE_USABLE_SIZE */
 
     return true;
 }
 
-bool vector_shrink_to_fit(Vector *vec) {
-    assert(vec);
+static size_t vector_header_size(const Vector *vec) {
+    if (vec->inline_value == (char *)vec + VECTOR_HEADER_SIZE) {
+        return VECTOR_HEADER_SIZE + vec->inline_capacity * vec->elem_size;
+    }
 
-    if (vec->elem_count < vec->capacity) {
-        size_t new_capacity = vec->elem_count;
-        void *res = realloc(vec->value, new_capacity * vec->elem_size);
-        if (NULL == res) {
-            return false;
-        }
+    return sizeof(struct Vector);
+}
 
-        vec->value = res;
-        vec->capacity = new_capacity;
+static size_t vector_padded_header_size(void) {
+    return (sizeof(struct Vector) + VECTOR_CACHE_LINE - 1) & ~(size_t)(VECTOR_CACHE_LINE - 1);
+}
 
-        return true;
+static Vector *vector_header_alloc(const VectorAllocator *allocator, const size_t alignment) {
+    if (alignment) {
+        return (Vector *)vector_mem_alloc_aligned(allocator, vector_padded_header_size(), VECTOR_CACHE_LINE);
     }
 
-    return false;
+    return (Vector *)vector_mem_alloc(allocator, sizeof(struct Vector));
 }
 
-bool vector_insert(Vector *vec, const size_t at, const void *src) {
-    assert(vec && src && at <= vec->elem_count);
-    
-    if (vec->elem_count >= vec->capacity) {
-        if (!vector_reserve(vec, vec->capacity * 2)) {
-            return false;
-        }
+static void vector_header_free(Vector *vec) {
+    if (vec->flags & VECTOR_FLAG_ALIGNED_HEADER) {
+        vector_mem_free_aligned(vec->allocator, vec, vector_padded_header_size(), VECTOR_CACHE_LINE);
+    } else {
+        vector_mem_free(vec->allocator, vec, vector_header_size(vec));
     }
 
-    memmove(
-        (char *)vec->value + (at + 1) * vec->elem_size,
-        (char *)vec->value + at * vec->elem_size,
-        (vec->elem_count - at) * vec->elem_size);
+    return;
+}
 
-    memcpy((char *)vec->value + at * vec->elem_size, src, vec->elem_size);
+static void *vector_storage_alloc(const Vector *vec, const size_t size) {
+    if (vec->alignment) {
+        return vector_mem_alloc_aligned(vec->allocator, size, vec->alignment);
+    }
 
-    ++vec->elem_count;
+    return vector_mem_alloc(vec->allocator, size);
+}
 
-    return true;
+static void vector_storage_free(const Vector *vec, void *ptr, const size_t size) {
+    if (vec->alignment) {
+        vector_mem_free_aligned(vec->allocator, ptr, size, vec->alignment);
+    } else {
+        vector_mem_free(vec->allocator, ptr, size);
+    }
+
+    return;
 }
 
-bool vector_erase(Vector *vec, size_t at) {
-    assert(vec && at < vec->elem_count);
+/* Drop vec's reference to shared storage; true if it was the last one. */
+static bool vector_release_share(Vector *vec) {
+    struct VectorShared *shared = vec->shared;
+    vec->shared = NULL;
 
-    if (vec->destructor) {
-        vec->destructor((char *)vec->value + at * vec->elem_size);
+    if (VECTOR_REF_RELEASE(&shared->refs) != 0) {
+        return false;
     }
 
-    memmove(
-        (char *)vec->value + at * vec->elem_size,
-        (char *)vec->value + (at + 1) * vec->elem_size,
-        (vec->elem_count - at - 1) * vec->elem_size);
+    vector_mem_free(vec->allocator, shared, sizeof(*shared));
 
-    --vec->elem_count;
-    
     return true;
 }
 
-void *vector_begin(const Vector *vec) {
-    assert(vec);
+/* Make vec the sole owner of its storage, copying it if other clones still share it. */
+static bool vector_own(Vector *vec) {
+    if (VECTOR_REF_LOAD(&vec->shared->refs) == 1) {
+        vector_release_share(vec);
+        return true;
+    }
 
-    return (char *)vec->value;
+    void *res = vector_storage_alloc(vec, vec->capacity * vec->elem_size);
+    if (NULL == res) {
+        return false;
+    }
+
+    VECTOR_STATS_MOVED(vec, vec->elem_count * vec->elem_size);
+    vector_copy(res, vec->value, vec->elem_count * vec->elem_size);
+
+    if (vector_release_share(vec)) {
+        /* The other sharers went away meanwhile. */
+        vector_storage_free(vec, vector_storage_base(vec), (vec->head + vec->capacity) * vec->elem_size);
+    }
+
+    vec->value = res;
+    vec->head = 0;
+
+    return true;
 }
 
-void *vector_end(const Vector *vec) {
-    assert(vec);
+/* Make vec's storage writable: false for read-only file mappings, or if a shared copy fails. */
+#define VECTOR_OWN(vec) (!((vec)->flags & VECTOR_FLAG_MAPPED) && (NULL == (vec)->shared || vector_own(vec)))
 
-    return (char *)vec->value + (vec->elem_count * vec->elem_size);
+#ifdef VECTOR_HAVE_VM
+static size_t vector_page_size(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+
+    return info.dwPageSize;
+#else
+    return (size_t)sysconf(_SC_PAGESIZE);
+#endif /* _WIN32 */
 }
 
-size_t vector_size(const Vector *vec) {
-    assert(vec);
+/* Round bytes up to whole pages, or return 0 on overflow. */
+static size_t vector_page_round(const size_t bytes) {
+    const size_t page = vector_page_size();
+    if (bytes > SIZE_MAX - (page - 1)) {
+        return 0;
+    }
 
-    return vec->elem_count;
+    return (bytes + page - 1) & ~(page - 1);
 }
 
-size_t vector_capacity(const Vector *vec) {
-    assert(vec);
+static void *vector_vm_reserve(const size_t bytes) {
+#if defined(_WIN32)
+    return VirtualAlloc(NULL, bytes, MEM_RESERVE, PAGE_NOACCESS);
+#else
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+    flags |= MAP_NORESERVE;
+#endif /* MAP_NORESERVE */
 
-    return vec->capacity;
+    void *ptr = mmap(NULL, bytes, PROT_NONE, flags, -1, 0);
+
+    return ptr == MAP_FAILED ? NULL : ptr;
+#endif /* _WIN32 */
 }
 
-bool vector_is_empty(const Vector *vec) {
-    assert(vec);
+static bool vector_vm_commit(void *ptr, const size_t bytes) {
+#if defined(_WIN32)
+    return VirtualAlloc(ptr, bytes, MEM_COMMIT, PAGE_READWRITE) != NULL;
+#else
+    return mprotect(ptr, bytes, PROT_READ | PROT_WRITE) == 0;
+#endif /* _WIN32 */
+}
 
-    return vec->elem_count == 0;
+/* Give the pages back to the OS; the range stays reserved. */
+static void vector_vm_decommit(void *ptr, const size_t bytes) {
+#if defined(_WIN32)
+    VirtualFree(ptr, bytes, MEM_DECOMMIT);
+#else
+    madvise(ptr, bytes, MADV_DONTNEED);
+    mprotect(ptr, bytes, PROT_NONE);
+#endif /* _WIN32 */
+
+    return;
 }
 
-void *vector_front(const Vector *vec) {
-    assert(vec && vec->elem_count > 0);
+static void vector_vm_release(void *ptr, const size_t bytes) {
+#if defined(_WIN32)
+    (void)bytes;
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    munmap(ptr, bytes);
+#endif /* _WIN32 */
 
-    return (char *)vec->value;
+    return;
 }
 
-void *vector_back(const Vector *vec) {
-    assert(vec && vec->elem_count > 0);
+/* Granularity of file mapping offsets. */
+static size_t vector_map_granularity(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
 
-    return (char *)vec->value + ((vec->elem_count - 1) * vec->elem_size);
+    return info.dwAllocationGranularity;
+#else
+    return vector_page_size();
+#endif /* _WIN32 */
 }
 
-void *vector_data(const Vector *vec) {
-    assert(vec);
+static void vector_file_unmap(void *value, const size_t bytes) {
+    char *base = (char *)((uintptr_t)value & ~(uintptr_t)(vector_map_granularity() - 1));
 
-    return (char *)vec->value;
+#if defined(_WIN32)
+    (void)bytes;
+    UnmapViewOfFile(base);
+#else
+    munmap(base, bytes);
+#endif /* _WIN32 */
+
+    return;
 }
 
-Vector *vector_clone(const Vector *vec) {
-    assert(vec);
+/*
+ * Commit or decommit pages so that at least *new_capacity elements
+ * fit, and report the capacity actually committed. Outgrowing the
+ * reservation moves the committed pages into a larger one with
+ * mremap on Linux (page tables only, no copy) and fails elsewhere.
+ */
+static bool vector_vm_resize(Vector *vec, size_t *new_capacity) {
+    const size_t committed = vector_page_round(vec->capacity * vec->elem_size);
+    const size_t wanted = vector_page_round(*new_capacity * vec->elem_size);
+    if (wanted == 0) {
+        return false;
+    }
 
-    Vector *clone = (Vector *)calloc(1, sizeof(Vector));
-    if (NULL == clone) {
-        return NULL;
+    if (wanted > vec->vm_reserved) {
+#if defined(__linux__)
+        size_t reserve = vec->vm_reserved > SIZE_MAX / 2 ? wanted : vec->vm_reserved * 2;
+        if (reserve < wanted) {
+            reserve = wanted;
+        }
+
+        void *fresh = vector_vm_reserve(reserve);
+        if (NULL == fresh) {
+            return false;
+        }
+
+        if (mremap(vec->value, committed, committed, MREMAP_MAYMOVE | MREMAP_FIXED, fresh) == MAP_FAILED) {
+            vector_vm_release(fresh, reserve);
+            return false;
+        }
+
+        if (vec->vm_reserved > committed) {
+            vector_vm_release((char *)vec->value + committed, vec->vm_reserved - committed);
+        }
+
+        vec->value = fresh;
+        vec->vm_reserved = reserve;
+#else
+        return false;
+#endif /* __linux__ */
     }
 
-    clone->value = malloc(vec->elem_count * vec->elem_size);
-    if (NULL == clone->value) {
-        free(clone);
-        return NULL;
+    if (wanted > committed) {
+        if (!vector_vm_commit((char *)vec->value + committed, wanted - committed)) {
+            return false;
+        }
+    } else if (wanted < committed) {
+        vector_vm_decommit((char *)vec->value + wanted, committed - wanted);
     }
 
-    clone->capacity = vec->elem_count;
-    clone->elem_count = vec->elem_count;
-    clone->elem_size = vec->elem_size;
-    clone->destructor = vec->destructor;
+    *new_capacity = wanted / vec->elem_size;
+
+    return true;
+}
+#endif /* VECTOR_HAVE_VM */
 
-    memcpy(clone->value, vec->value, (vec->elem_count * vec->elem_size));
+static bool vector_storage_resize(Vector *vec, size_t new_capacity) {
+    const size_t old_capacity = vec->capacity;
+    void *res = NULL;
 
-    return clone;
+    if (!VECTOR_OWN(vec)) {
+        return false;
+    }
+
+    vector_drop_slack(vec);
+
+#ifdef VECTOR_HAVE_VM
+    if (vec->flags & VECTOR_FLAG_VM) {
+        if (!vector_vm_resize(vec, &new_capacity)) {
+            return false;
+        }
+
+        res = vec->value;
+    } else
+#endif /* VECTOR_HAVE_VM */
+    if (vec->flags & VECTOR_FLAG_INLINE) {
+        res = vector_storage_alloc(vec, new_capacity * vec->elem_size);
+        if (NULL == res) {
+            return false;
+        }
+
+        vector_copy(res, vec->value, vec->elem_count * vec->elem_size);
+        vec->flags &= ~VECTOR_FLAG_INLINE;
+    } else if (vec->inline_value && new_capacity <= vec->inline_capacity) {
+        res = vec->inline_value;
+        vector_copy(res, vec->value, vec->elem_count * vec->elem_size);
+        vector_storage_free(vec, vec->value, vec->capacity * vec->elem_size);
+        vec->flags |= VECTOR_FLAG_INLINE;
+        new_capacity = vec->inline_capacity;
+    } else if (vec->alignment) {
+        /* realloc would not preserve the alignment offset. */
+        res = vector_storage_alloc(vec, new_capacity * vec->elem_size);
+        if (NULL == res) {
+            return false;
+        }
+
+        vector_copy(res, vec->value, vec->elem_count * vec->elem_size);
+        vector_storage_free(vec, vec->value, vec->capacity * vec->elem_size);
+    } else {
+        res = vector_mem_realloc(vec->allocator, vec->value,
+                                 vec->capacity * vec->elem_size,
+                                 new_capacity * vec->elem_size);
+        if (NULL == res) {
+            return false;
+        }
+    }
+
+    vec->value = res;
+    vec->capacity = new_capacity;
+
+    VECTOR_STATS_RESIZED(vec, old_capacity);
+    (void)old_capacity;
+
+    return true;
+}
+
+static void vector_storage_release(Vector *vec) {
+#ifdef VECTOR_HAVE_VM
+    if (vec->flags & VECTOR_FLAG_VM) {
+        vector_vm_release(vector_storage_base(vec), vec->vm_reserved);
+        return;
+    }
+
+    if (vec->flags & VECTOR_FLAG_MAPPED) {
+        vector_file_unmap(vector_storage_base(vec), vec->vm_reserved);
+        return;
+    }
+#endif /* VECTOR_HAVE_VM */
+
+    if (!(vec->flags & VECTOR_FLAG_INLINE)) {
+        vector_storage_free(vec, vector_storage_base(vec), (vec->head + vec->capacity) * vec->elem_size);
+    }
+
+    return;
+}
+
+static void vector_destroy_elements(Vector *vec, const size_t first, const size_t count) {
+    if (vec->destroy_range) {
+        if (count > 0) {
+            vec->destroy_range((char *)vec->value + first * vec->elem_size, count);
+        }
+    } else if (vec->destructor) {
+        for (char *ptr = (char *)vec->value + first * vec->elem_size;
+             ptr < (char *)vec->value + (first + count) * vec->elem_size;
+             ptr += vec->elem_size) {
+            vec->destructor(ptr);
+        }
+    }
+
+    return;
+}
+
+static void *vector_open_gap(Vector *vec, const size_t at, const size_t count) {
+    if (!VECTOR_OWN(vec)) {
+        return NULL;
+    }
+
+    if (count > vec->capacity - vec->elem_count) {
+        if (!vector_grow(vec, count)) {
+            return NULL;
+        }
+    }
+
+    char *gap = (char *)vec->value + at * vec->elem_size;
+
+    VECTOR_STATS_MOVED(vec, (vec->elem_count - at) * vec->elem_size);
+
+    memmove(
+        gap + count * vec->elem_size,
+        gap,
+        (vec->elem_count - at) * vec->elem_size);
+
+    vec->elem_count += count;
+
+    return gap;
+}
+
+#ifdef VECTOR_THREAD_LOCAL
+/*
+ * Per-thread cache of destroyed heap vectors. A cached vector keeps
+ * its header and storage, with elem_size 1 and capacity in bytes;
+ * inline_value links it to the next vector of its bin.
+ */
+typedef struct VectorThreadCache {
+    Vector *bins[VECTOR_CACHE_BINS];
+    size_t bytes;
+    size_t limit;
+} VectorThreadCache;
+
+static VECTOR_THREAD_LOCAL VectorThreadCache vector_thread_cache;
+
+static unsigned vector_cache_log2(size_t bytes) {
+    unsigned log = 0;
+    while (bytes >>= 1) {
+        ++log;
+    }
+
+    return log;
+}
+
+/* Take a cached vector with at least bytes of storage, or return NULL. */
+static Vector *vector_cache_take(const size_t bytes) {
+    VectorThreadCache *cache = &vector_thread_cache;
+    if (cache->bytes == 0) {
+        return NULL;
+    }
+
+    /* Round up so that every vector in the first bin is big enough. */
+    unsigned bin = vector_cache_log2(bytes);
+    bin += bytes > ((size_t)1 << bin);
+
+    for (unsigned end = bin + 2; bin < end && bin < VECTOR_CACHE_BINS; ++bin) {
+        Vector *vec = cache->bins[bin];
+        if (vec) {
+            cache->bins[bin] = (Vector *)vec->inline_value;
+            cache->bytes -= sizeof(struct Vector) + vec->capacity;
+            vec->inline_value = NULL;
+            return vec;
+        }
+    }
+
+    return NULL;
+}
+
+/* Keep a plain heap vector whose elements are destroyed; false if it does not qualify. */
+static bool vector_cache_put(Vector *vec) {
+    VectorThreadCache *cache = &vector_thread_cache;
+
+    /* Spilled inline vectors also have no flags, but a header bigger than sizeof(Vector). */
+    if (vec->flags != 0 || vec->inline_capacity != 0 || vec->allocator != &vector_default_allocator ||
+        vec->alignment != 0) {
+        return false;
+    }
+
+    vector_reset_head(vec);
+
+    const size_t bytes = vec->capacity * vec->elem_size;
+    const size_t entry = sizeof(struct Vector) + bytes;
+    if (entry > cache->limit || cache->bytes > cache->limit - entry) {
+        return false;
+    }
+
+    const unsigned bin = vector_cache_log2(bytes);
+
+    vec->elem_size = 1;
+    vec->capacity = bytes;
+    vec->elem_count = 0;
+    vec->inline_value = (void *)cache->bins[bin];
+    cache->bins[bin] = vec;
+    cache->bytes += sizeof(struct Vector) + bytes;
+
+    return true;
+}
+#else
+static Vector *vector_cache_take(const size_t bytes) {
+    (void)bytes;
+
+    return NULL;
+}
+
+static bool vector_cache_put(Vector *vec) {
+    (void)vec;
+
+    return false;
+}
+#endif /* VECTOR_THREAD_LOCAL */
+
+void vector_thread_cache_trim(const size_t max_bytes) {
+#ifdef VECTOR_THREAD_LOCAL
+    VectorThreadCache *cache = &vector_thread_cache;
+
+    /* Largest first: fewest frees to get under the cap. */
+    for (unsigned bin = VECTOR_CACHE_BINS; bin-- > 0 && cache->bytes > max_bytes;) {
+        while (cache->bins[bin] && cache->bytes > max_bytes) {
+            Vector *vec = cache->bins[bin];
+            cache->bins[bin] = (Vector *)vec->inline_value;
+            cache->bytes -= sizeof(struct Vector) + vec->capacity;
+
+            vector_mem_free(vec->allocator, vec->value, vec->capacity);
+            vector_mem_free(vec->allocator, vec, sizeof(struct Vector));
+        }
+    }
+#else
+    (void)max_bytes;
+#endif /* VECTOR_THREAD_LOCAL */
+
+    return;
+}
+
+void vector_thread_cache_set_limit(const size_t max_bytes) {
+#ifdef VECTOR_THREAD_LOCAL
+    vector_thread_cache.limit = max_bytes;
+    vector_thread_cache_trim(max_bytes);
+#else
+    (void)max_bytes;
+#endif /* VECTOR_THREAD_LOCAL */
+
+    return;
+}
+
+size_t vector_thread_cache_bytes(void) {
+#ifdef VECTOR_THREAD_LOCAL
+    return vector_thread_cache.bytes;
+#else
+    return 0;
+#endif /* VECTOR_THREAD_LOCAL */
+}
+
+Vector *vector_create(const size_t capacity, const size_t elem_size, void (*destructor)(void *)) {
+    return vector_create_with_allocator(capacity, elem_size, destructor, NULL);
+}
+
+static Vector *vector_create_internal(const size_t capacity,
+                                     const size_t elem_size,
+                                     void (*destructor)(void *),
+                                     const VectorAllocator *allocator,
+                                     const size_t alignment) {
+    assert(elem_size > 0);
+    assert(allocator == NULL || allocator->allocate);
+    assert((alignment & (alignment - 1)) == 0);
+
+    if (NULL == allocator) {
+        allocator = &vector_default_allocator;
+    }
+
+    Vector *vec = NULL;
+    if (allocator == &vector_default_allocator && alignment == 0 && capacity <= SIZE_MAX / elem_size) {
+        vec = vector_cache_take((capacity == 0 ? 1 : capacity) * elem_size);
+    }
+
+    if (vec) {
+        vec->capacity = vec->capacity / elem_size;
+    } else {
+        vec = vector_header_alloc(allocator, alignment);
+        if (NULL == vec) {
+            return NULL;
+        }
+
+        vec->value = NULL;
+        vec->capacity = capacity == 0 ? 1 : capacity;
+    }
+
+    vec->elem_size = elem_size;
+    vec->elem_count = 0;
+    vec->destructor = destructor == NULL ? NULL : destructor;
+    vec->destroy_range = NULL;
+    vec->allocator = allocator;
+    vec->growth = vector_default_growth;
+    vec->flags = alignment ? VECTOR_FLAG_ALIGNED_HEADER : 0;
+    vec->inline_value = NULL;
+    vec->inline_capacity = 0;
+    vec->alignment = alignment;
+    vec->head = 0;
+    vec->vm_reserved = 0;
+    vec->shared = NULL;
+
+    if (NULL == vec->value) {
+        vec->value = vec->capacity > SIZE_MAX / elem_size ? NULL : vector_storage_alloc(vec, vec->capacity * vec->elem_size);
+        if (NULL == vec->value) {
+            vector_header_free(vec);
+            return NULL;
+        }
+    }
+
+    VECTOR_STATS_REGISTER(vec);
+
+    return vec;
+}
+
+Vector *vector_create_with_allocator(const size_t capacity,
+                                     const size_t elem_size,
+                                     void (*destructor)(void *),
+                                     const VectorAllocator *allocator) {
+    return vector_create_internal(capacity, elem_size, destructor, allocator, 0);
+}
+
+Vector *vector_create_aligned(const size_t capacity,
+                              const size_t elem_size,
+                              const size_t alignment,
+                              void (*destructor)(void *)) {
+    assert(alignment > 0);
+
+    return vector_create_internal(capacity, elem_size, destructor, NULL, alignment);
+}
+
+Vector *vector_create_reserved(const size_t max_capacity, const size_t elem_size, void (*destructor)(void *)) {
+    assert(elem_size > 0);
+
+#ifdef VECTOR_HAVE_VM
+    const size_t reserve = max_capacity > SIZE_MAX / elem_size ? 0 : vector_page_round((max_capacity ? max_capacity : 1) * elem_size);
+    const size_t initial = vector_page_round(elem_size);
+    if (reserve == 0 || initial == 0) {
+        return NULL;
+    }
+
+    const VectorAllocator *allocator = &vector_default_allocator;
+    Vector *vec = (Vector *)vector_mem_alloc(allocator, sizeof(struct Vector));
+    if (NULL == vec) {
+        return NULL;
+    }
+
+    vec->value = vector_vm_reserve(reserve);
+    if (NULL == vec->value) {
+        vector_mem_free(allocator, vec, sizeof(struct Vector));
+        return NULL;
+    }
+
+    const size_t committed = initial < reserve ? initial : reserve;
+    if (!vector_vm_commit(vec->value, committed)) {
+        vector_vm_release(vec->value, reserve);
+        vector_mem_free(allocator, vec, sizeof(struct Vector));
+        return NULL;
+    }
+
+    vec->capacity = committed / elem_size;
+    vec->elem_size = elem_size;
+    vec->elem_count = 0;
+    vec->destructor = destructor;
+    vec->destroy_range = NULL;
+    vec->allocator = allocator;
+    vec->growth = vector_default_growth;
+    vec->flags = VECTOR_FLAG_VM;
+    vec->inline_value = NULL;
+    vec->inline_capacity = 0;
+    vec->alignment = 0;
+    vec->head = 0;
+    vec->vm_reserved = reserve;
+    vec->shared = NULL;
+
+    VECTOR_STATS_REGISTER(vec);
+
+    return vec;
+#else
+    (void)max_capacity;
+
+    return vector_create(0, elem_size, destructor);
+#endif /* VECTOR_HAVE_VM */
+}
+
+Vector *vector_create_inline(const size_t capacity, const size_t elem_size, void (*destructor)(void *)) {
+    assert(elem_size > 0);
+
+    const size_t inline_capacity = capacity == 0 ? 1 : capacity;
+    if (inline_capacity > (SIZE_MAX - VECTOR_HEADER_SIZE) / elem_size) {
+        return NULL;
+    }
+
+    const VectorAllocator *allocator = &vector_default_allocator;
+    Vector *vec = (Vector *)vector_mem_alloc(allocator, VECTOR_HEADER_SIZE + inline_capacity * elem_size);
+    if (NULL == vec) {
+        return NULL;
+    }
+
+    vec->inline_value = (char *)vec + VECTOR_HEADER_SIZE;
+    vec->inline_capacity = inline_capacity;
+    vec->value = vec->inline_value;
+    vec->capacity = inline_capacity;
+    vec->elem_size = elem_size;
+    vec->elem_count = 0;
+    vec->destructor = destructor;
+    vec->destroy_range = NULL;
+    vec->allocator = allocator;
+    vec->growth = vector_default_growth;
+    vec->flags = VECTOR_FLAG_INLINE;
+    vec->alignment = 0;
+    vec->head = 0;
+    vec->vm_reserved = 0;
+    vec->shared = NULL;
+
+    VECTOR_STATS_REGISTER(vec);
+
+    return vec;
+}
+
+bool vector_init(Vector *vec, const size_t capacity, const size_t elem_size, void (*destructor)(void *)) {
+    assert(vec && elem_size > 0);
+
+    vec->capacity = capacity == 0 ? 1 : capacity;
+    vec->elem_size = elem_size;
+    vec->elem_count = 0;
+    vec->destructor = destructor;
+    vec->destroy_range = NULL;
+    vec->allocator = &vector_default_allocator;
+    vec->growth = vector_default_growth;
+    vec->flags = VECTOR_FLAG_EMBEDDED;
+    vec->inline_value = NULL;
+    vec->inline_capacity = 0;
+    vec->alignment = 0;
+    vec->head = 0;
+    vec->vm_reserved = 0;
+    vec->shared = NULL;
+
+    if (vec->capacity > SIZE_MAX / elem_size) {
+        return false;
+    }
+
+    vec->value = vector_mem_alloc(vec->allocator, vec->capacity * vec->elem_size);
+    if (NULL == vec->value) {
+        return false;
+    }
+
+    VECTOR_STATS_REGISTER(vec);
+
+    return true;
+}
+
+void vector_init_in_place(Vector *vec,
+                          void *buf,
+                          const size_t capacity,
+                          const size_t elem_size,
+                          void (*destructor)(void *)) {
+    assert(vec && buf && capacity > 0 && elem_size > 0);
+
+    vec->value = buf;
+    vec->capacity = capacity;
+    vec->elem_size = elem_size;
+    vec->elem_count = 0;
+    vec->destructor = destructor;
+    vec->destroy_range = NULL;
+    vec->allocator = &vector_default_allocator;
+    vec->growth = vector_default_growth;
+    vec->flags = VECTOR_FLAG_EMBEDDED | VECTOR_FLAG_INLINE;
+    vec->inline_value = buf;
+    vec->inline_capacity = capacity;
+    vec->alignment = 0;
+    vec->head = 0;
+    vec->vm_reserved = 0;
+    vec->shared = NULL;
+
+    VECTOR_STATS_REGISTER(vec);
+
+    return;
+}
+
+void vector_deinit(Vector *vec) {
+    assert(vec && (vec->flags & VECTOR_FLAG_EMBEDDED));
+
+    VECTOR_STATS_UNREGISTER(vec);
+
+    if (NULL == vec->shared || vector_release_share(vec)) {
+        vector_destroy_elements(vec, 0, vec->elem_count);
+        vector_storage_release(vec);
+    }
+
+    vec->value = NULL;
+    vec->elem_count = 0;
+    vec->capacity = 0;
+    vec->head = 0;
+
+    return;
+}
+
+void vector_set_growth_policy(Vector *vec, const VectorGrowthPolicy *policy) {
+    assert(vec);
+    assert(policy == NULL || policy->kind != VECTOR_GROWTH_CUSTOM || policy->grow);
+
+    vec->growth = policy == NULL ? vector_default_growth : *policy;
+
+    return;
+}
+
+void vector_set_range_destructor(Vector *vec, void (*destroy_range)(void *first, size_t count)) {
+    assert(vec && NULL == vec->shared);
+
+    vec->destroy_range = destroy_range;
+
+    return;
+}
+
+void vector_destroy(Vector *vec) {
+    assert(vec && !(vec->flags & VECTOR_FLAG_EMBEDDED));
+
+    VECTOR_STATS_UNREGISTER(vec);
+
+    if (NULL == vec->shared || vector_release_share(vec)) {
+        vector_destroy_elements(vec, 0, vec->elem_count);
+
+        if (vector_cache_put(vec)) {
+            return;
+        }
+
+        vector_storage_release(vec);
+    }
+
+    vector_header_free(vec);
+
+    return;
+}
+
+void vector_reset(Vector *vec) {
+    assert(vec);
+
+    vec->elem_count = 0;
+    vector_reset_head(vec);
+
+    return;
+}
+
+void vector_clear(Vector *vec) {
+    assert(vec);
+
+    /* Other sharers still hold these elements: just stop seeing them. */
+    if (NULL == vec->shared || VECTOR_REF_LOAD(&vec->shared->refs) == 1) {
+        if (vec->shared) {
+            vector_release_share(vec);
+        }
+
+        vector_destroy_elements(vec, 0, vec->elem_count);
+    }
+
+    vector_reset(vec);
+
+    return;
+}
+
+void *vector_push_back(Vector *vec, const void *elem) {
+    assert(vec && elem);
+
+    if (!VECTOR_OWN(vec)) {
+        return NULL;
+    }
+
+    if (vec->elem_count >= vec->capacity) {
+        if (!vector_grow(vec, 1)) {
+            return NULL;
+        }
+    }
+
+    memcpy((char *)vec->value + vec->elem_count * vec->elem_size, elem, vec->elem_size);
+
+    ++vec->elem_count;
+
+    return ((char *)vec->value + ((vec->elem_count - 1) * vec->elem_size));
+}
+
+void *vector_emplace_back(Vector *vec) {
+    assert(vec);
+
+    return vector_open_gap(vec, vec->elem_count, 1);
+}
+
+void *vector_push_uninit(Vector *vec, const size_t count) {
+    assert(vec);
+
+    return vector_open_gap(vec, vec->elem_count, count);
+}
+
+void *vector_emplace_at(Vector *vec, const size_t at) {
+    assert(vec && at <= vec->elem_count);
+
+    return vector_open_gap(vec, at, 1);
+}
+
+bool vector_pop_back(Vector *vec, void **out) {
+    return vector_pop_back_into(vec, out);
+}
+
+bool vector_pop_back_into(Vector *vec, void *out) {
+    assert(vec && out && vec->elem_count);
+
+    --vec->elem_count;
+
+    memcpy(out, (char *)vec->value + (vec->elem_count * vec->elem_size), vec->elem_size);
+
+    return true;
+}
+
+bool vector_pop_back_n(Vector *vec, const size_t count, void *out) {
+    assert(vec && count <= vec->elem_count);
+
+    const size_t first = vec->elem_count - count;
+
+    if (out) {
+        memcpy(out, (char *)vec->value + (first * vec->elem_size), count * vec->elem_size);
+    } else {
+        vector_destroy_elements(vec, first, count);
+    }
+
+    vec->elem_count = first;
+
+    return true;
+}
+
+void *vector_take_back(Vector *vec) {
+    assert(vec && vec->elem_count);
+
+    --vec->elem_count;
+
+    return (char *)vec->value + (vec->elem_count * vec->elem_size);
+}
+
+void *vector_push_front(Vector *vec, const void *elem) {
+    assert(vec && elem);
+
+    void *slot = vector_emplace_front(vec);
+    if (NULL == slot) {
+        return NULL;
+    }
+
+    memcpy(slot, elem, vec->elem_size);
+
+    return slot;
+}
+
+void *vector_emplace_front(Vector *vec) {
+    assert(vec);
+
+    if (!VECTOR_OWN(vec)) {
+        return NULL;
+    }
+
+    if (vec->head == 0) {
+        /* Shift into the back half of the free space so the next pushes are O(1). */
+        if (vec->capacity - vec->elem_count <= vec->elem_count / 2) {
+            if (!vector_grow(vec, vec->elem_count + 1)) {
+                return NULL;
+            }
+        }
+
+        const size_t shift = (vec->capacity - vec->elem_count + 1) / 2;
+        char *dst = (char *)vec->value + shift * vec->elem_size;
+
+        VECTOR_STATS_MOVED(vec, vec->elem_count * vec->elem_size);
+        memmove(dst, vec->value, vec->elem_count * vec->elem_size);
+
+        vec->value = dst;
+        vec->head = shift;
+        vec->capacity -= shift;
+    }
+
+    vec->value = (char *)vec->value - vec->elem_size;
+    --vec->head;
+    ++vec->capacity;
+    ++vec->elem_count;
+
+    return vec->value;
+}
+
+bool vector_pop_front(Vector *vec, void *out) {
+    return vector_pop_front_n(vec, 1, out);
+}
+
+bool vector_pop_front_n(Vector *vec, const size_t count, void *out) {
+    assert(vec && count <= vec->elem_count);
+
+    if (out) {
+        memcpy(out, vec->value, count * vec->elem_size);
+    } else {
+        vector_destroy_elements(vec, 0, count);
+    }
+
+    vec->value = (char *)vec->value + count * vec->elem_size;
+    vec->head += count;
+    vec->capacity -= count;
+    vec->elem_count -= count;
+
+    if (vec->elem_count == 0) {
+        vector_reset_head(vec);
+    }
+
+    return true;
+}
+
+void *vector_linearize(Vector *vec) {
+    assert(vec);
+
+    if (vec->head && VECTOR_OWN(vec)) {
+        vector_drop_slack(vec);
+    }
+
+    return vec->value;
+}
+
+void *vector_at(const Vector *vec, const size_t idx) {
+    assert(vec);
+    assert(idx < vec->elem_count);
+    
+    return ((char *)vec->value + (idx * vec->elem_size));
+}
+
+void *vector_at_unchecked(const Vector *vec, const size_t idx) {
+    return ((char *)vec->value + (idx * vec->elem_size));
+}
+
+void vector_prefetch_range(const Vector *vec, const size_t first, const size_t count) {
+    assert(vec && first <= vec->elem_count && count <= vec->elem_count - first);
+
+    const char *ptr = (const char *)vec->value + first * vec->elem_size;
+    const char *end = ptr + count * vec->elem_size;
+
+    for (; ptr < end; ptr += VECTOR_CACHE_LINE) {
+        VECTOR_PREFETCH(ptr);
+    }
+
+    return;
+}
+
+bool vector_reserve(Vector *vec, const size_t capacity) {
+    assert(vec);
+
+    if (capacity <= vec->capacity || capacity > SIZE_MAX / vec->elem_size) {
+        return false;
+    }
+
+    return vector_storage_resize(vec, capacity);
+}
+
+bool vector_shrink_to_fit(Vector *vec) {
+    assert(vec);
+
+    size_t new_capacity = vec->elem_count == 0 ? 1 : vec->elem_count;
+    if (new_capacity < vec->head + vec->capacity && !(vec->flags & VECTOR_FLAG_INLINE)) {
+        return vector_storage_resize(vec, new_capacity);
+    }
+
+    return false;
+}
+
+bool vector_insert(Vector *vec, const size_t at, const void *src) {
+    assert(vec && src && at <= vec->elem_count);
+
+    void *slot = vector_open_gap(vec, at, 1);
+    if (NULL == slot) {
+        return false;
+    }
+
+    memcpy(slot, src, vec->elem_size);
+
+    return true;
+}
+
+bool vector_erase(Vector *vec, size_t at) {
+    assert(vec && at < vec->elem_count);
+
+    if (!VECTOR_OWN(vec)) {
+        return false;
+    }
+
+    vector_destroy_elements(vec, at, 1);
+
+    VECTOR_STATS_MOVED(vec, (vec->elem_count - at - 1) * vec->elem_size);
+
+    memmove(
+        (char *)vec->value + at * vec->elem_size,
+        (char *)vec->value + (at + 1) * vec->elem_size,
+        (vec->elem_count - at - 1) * vec->elem_size);
+
+    --vec->elem_count;
+    
+    return true;
+}
+
+void *vector_append_n(Vector *vec, const void *src, const size_t count) {
+    assert(vec && (src || count == 0));
+
+    void *dst = vector_open_gap(vec, vec->elem_count, count);
+    if (NULL == dst) {
+        return NULL;
+    }
+
+    if (count) {
+        memcpy(dst, src, count * vec->elem_size);
+    }
+
+    return dst;
+}
+
+bool vector_insert_range(Vector *vec, const size_t at, const void *src, const size_t count) {
+    assert(vec && (src || count == 0) && at <= vec->elem_count);
+
+    if (count == 0) {
+        return true;
+    }
+
+    void *dst = vector_open_gap(vec, at, count);
+    if (NULL == dst) {
+        return false;
+    }
+
+    memcpy(dst, src, count * vec->elem_size);
+
+    return true;
+}
+
+bool vector_erase_range(Vector *vec, const size_t first, const size_t count) {
+    assert(vec && first <= vec->elem_count && count <= vec->elem_count - first);
+
+    if (count == 0) {
+        return true;
+    }
+
+    if (!VECTOR_OWN(vec)) {
+        return false;
+    }
+
+    vector_destroy_elements(vec, first, count);
+
+    VECTOR_STATS_MOVED(vec, (vec->elem_count - first - count) * vec->elem_size);
+
+    memmove(
+        (char *)vec->value + first * vec->elem_size,
+        (char *)vec->value + (first + count) * vec->elem_size,
+        (vec->elem_count - first - count) * vec->elem_size);
+
+    vec->elem_count -= count;
+
+    return true;
+}
+
+bool vector_swap_remove(Vector *vec, const size_t at) {
+    assert(vec && at < vec->elem_count);
+
+    if (!VECTOR_OWN(vec)) {
+        return false;
+    }
+
+    vector_destroy_elements(vec, at, 1);
+
+    --vec->elem_count;
+
+    if (at != vec->elem_count) {
+        memcpy((char *)vec->value + at * vec->elem_size,
+               (char *)vec->value + vec->elem_count * vec->elem_size,
+               vec->elem_size);
+    }
+
+    return true;
+}
+
+size_t vector_remove_if(Vector *vec, bool (*pred)(const void *elem, void *ctx), void *ctx) {
+    assert(vec && pred);
+
+    if (!VECTOR_OWN(vec)) {
+        return 0;
+    }
+
+    const size_t elem_size = vec->elem_size;
+    char *base = (char *)vec->value;
+    size_t write = 0;
+    size_t read = 0;
+
+    /* Move kept elements run by run rather than one at a time. */
+    while (read < vec->elem_count) {
+        if (pred(base + read * elem_size, ctx)) {
+            vector_destroy_elements(vec, read, 1);
+            ++read;
+            continue;
+        }
+
+        size_t run_end = read + 1;
+        while (run_end < vec->elem_count && !pred(base + run_end * elem_size, ctx)) {
+            ++run_end;
+        }
+
+        if (write != read) {
+            VECTOR_STATS_MOVED(vec, (run_end - read) * elem_size);
+            memmove(base + write * elem_size, base + read * elem_size, (run_end - read) * elem_size);
+        }
+
+        write += run_end - read;
+
+        if (run_end < vec->elem_count) {
+            vector_destroy_elements(vec, run_end, 1);
+            ++run_end;
+        }
+
+        read = run_end;
+    }
+
+    const size_t removed = vec->elem_count - write;
+    vec->elem_count = write;
+
+    return removed;
+}
+
+size_t vector_remove_if_unordered(Vector *vec, bool (*pred)(const void *elem, void *ctx), void *ctx) {
+    assert(vec && pred);
+
+    if (!VECTOR_OWN(vec)) {
+        return 0;
+    }
+
+    const size_t elem_size = vec->elem_size;
+    char *base = (char *)vec->value;
+    size_t front = 0;
+    size_t back = vec->elem_count;
+
+    /* Fill holes at the front with kept elements taken from the back. */
+    while (front < back) {
+        if (!pred(base + front * elem_size, ctx)) {
+            ++front;
+            continue;
+        }
+
+        vector_destroy_elements(vec, front, 1);
+
+        while (--back > front && pred(base + back * elem_size, ctx)) {
+            vector_destroy_elements(vec, back, 1);
+        }
+
+        if (back > front) {
+            memcpy(base + front * elem_size, base + back * elem_size, elem_size);
+            ++front;
+        }
+    }
+
+    const size_t removed = vec->elem_count - front;
+    vec->elem_count = front;
+
+    return removed;
+}
+
+void *vector_begin(const Vector *vec) {
+    assert(vec);
+
+    return (char *)vec->value;
+}
+
+void *vector_end(const Vector *vec) {
+    assert(vec);
+
+    return (char *)vec->value + (vec->elem_count * vec->elem_size);
+}
+
+size_t vector_size(const Vector *vec) {
+    assert(vec);
+
+    return vec->elem_count;
+}
+
+size_t vector_capacity(const Vector *vec) {
+    assert(vec);
+
+    return vec->capacity;
+}
+
+bool vector_is_empty(const Vector *vec) {
+    assert(vec);
+
+    return vec->elem_count == 0;
+}
+
+void *vector_front(const Vector *vec) {
+    assert(vec && vec->elem_count > 0);
+
+    return (char *)vec->value;
+}
+
+void *vector_back(const Vector *vec) {
+    assert(vec && vec->elem_count > 0);
+
+    return (char *)vec->value + ((vec->elem_count - 1) * vec->elem_size);
+}
+
+void *vector_data(const Vector *vec) {
+    assert(vec);
+
+    return (char *)vec->value;
+}
+
+Vector *vector_clone_empty(const Vector *vec, const size_t capacity) {
+    assert(vec);
+
+    Vector *clone = vector_header_alloc(vec->allocator, vec->alignment);
+    if (NULL == clone) {
+        return NULL;
+    }
+
+    clone->capacity = capacity == 0 ? 1 : capacity;
+    clone->elem_count = 0;
+    clone->elem_size = vec->elem_size;
+    clone->destructor = vec->destructor;
+    clone->destroy_range = vec->destroy_range;
+    clone->allocator = vec->allocator;
+    clone->growth = vec->growth;
+    clone->flags = vec->alignment ? VECTOR_FLAG_ALIGNED_HEADER : 0;
+    clone->inline_value = NULL;
+    clone->inline_capacity = 0;
+    clone->alignment = vec->alignment;
+    clone->head = 0;
+    clone->vm_reserved = 0;
+    clone->shared = NULL;
+
+    if (clone->capacity > SIZE_MAX / clone->elem_size) {
+        vector_header_free(clone);
+        return NULL;
+    }
+
+    clone->value = vector_storage_alloc(clone, clone->capacity * clone->elem_size);
+    if (NULL == clone->value) {
+        vector_header_free(clone);
+        return NULL;
+    }
+
+    VECTOR_STATS_REGISTER(clone);
+#ifdef VECTOR_STATS
+    clone->stats.label = vec->stats.label;
+#endif /* VECTOR_STATS */
+
+    return clone;
+}
+
+Vector *vector_clone(const Vector *vec) {
+    assert(vec);
+
+    Vector *clone = vector_clone_empty(vec, vec->elem_count);
+    if (NULL == clone) {
+        return NULL;
+    }
+
+    vector_copy(clone->value, vec->value, (vec->elem_count * vec->elem_size));
+    clone->elem_count = vec->elem_count;
+
+    return clone;
+}
+
+Vector *vector_clone_deep(const Vector *vec, bool (*copy)(void *dst, const void *src, void *ctx), void *ctx) {
+    assert(vec && copy);
+
+    Vector *clone = vector_clone_empty(vec, vec->elem_count);
+    if (NULL == clone) {
+        return NULL;
+    }
+
+    char *dst = (char *)clone->value;
+    const char *src = (const char *)vec->value;
+
+    for (size_t i = 0; i < vec->elem_count; ++i) {
+        if (!copy(dst + i * vec->elem_size, src + i * vec->elem_size, ctx)) {
+            clone->elem_count = i;
+            vector_destroy(clone);
+            return NULL;
+        }
+    }
+
+    clone->elem_count = vec->elem_count;
+
+    return clone;
+}
+
+Vector *vector_clone_deep_range(const Vector *vec,
+                                bool (*copy_range)(void *dst, const void *src, size_t count, void *ctx),
+                                void *ctx) {
+    assert(vec && copy_range);
+
+    Vector *clone = vector_clone_empty(vec, vec->elem_count);
+    if (NULL == clone) {
+        return NULL;
+    }
+
+    if (vec->elem_count > 0 && !copy_range(clone->value, vec->value, vec->elem_count, ctx)) {
+        vector_destroy(clone);
+        return NULL;
+    }
+
+    clone->elem_count = vec->elem_count;
+
+    return clone;
+}
+
+Vector *vector_clone_cow(Vector *vec) {
+    assert(vec);
+
+    /* Owned elements cannot be shared: a bitwise private copy would destroy them twice. */
+    if ((vec->flags & (VECTOR_FLAG_INLINE | VECTOR_FLAG_VM | VECTOR_FLAG_MAPPED)) || vec->destructor ||
+        vec->destroy_range) {
+        return vector_clone(vec);
+    }
+
+    if (NULL == vec->shared) {
+        vec->shared = (struct VectorShared *)vector_mem_alloc(vec->allocator, sizeof(struct VectorShared));
+        if (NULL == vec->shared) {
+            return NULL;
+        }
+
+        vec->shared->refs = 1;
+    }
+
+    Vector *clone = vector_header_alloc(vec->allocator, vec->alignment);
+    if (NULL == clone) {
+        return NULL;
+    }
+
+    VECTOR_REF_ACQUIRE(&vec->shared->refs);
+
+    clone->value = vec->value;
+    clone->capacity = vec->capacity;
+    clone->head = vec->head;
+    clone->elem_count = vec->elem_count;
+    clone->elem_size = vec->elem_size;
+    clone->destructor = vec->destructor;
+    clone->destroy_range = vec->destroy_range;
+    clone->allocator = vec->allocator;
+    clone->growth = vec->growth;
+    clone->flags = vec->alignment ? VECTOR_FLAG_ALIGNED_HEADER : 0;
+    clone->inline_value = NULL;
+    clone->inline_capacity = 0;
+    clone->alignment = vec->alignment;
+    clone->vm_reserved = 0;
+    clone->shared = vec->shared;
+
+    VECTOR_STATS_REGISTER(clone);
+#ifdef VECTOR_STATS
+    clone->stats.label = vec->stats.label;
+#endif /* VECTOR_STATS */
+
+    return clone;
+}
+
+void *vector_at_mut(Vector *vec, const size_t idx) {
+    assert(vec);
+    assert(idx < vec->elem_count);
+
+    if (!VECTOR_OWN(vec)) {
+        return NULL;
+    }
+
+    return ((char *)vec->value + (idx * vec->elem_size));
+}
+
+void *vector_data_mut(Vector *vec) {
+    assert(vec);
+
+    if (!VECTOR_OWN(vec)) {
+        return NULL;
+    }
+
+    return (char *)vec->value;
+}
+
+/* Whether storage cannot hold capacity elements by design, however much memory is free. */
+static bool vector_storage_fixed(const Vector *vec, const size_t capacity) {
+#if defined(VECTOR_HAVE_VM) && !defined(__linux__)
+    /* Only Linux can move a reservation that runs out. */
+    if ((vec->flags & VECTOR_FLAG_VM) && capacity > vec->vm_reserved / vec->elem_size) {
+        return true;
+    }
+#endif /* VECTOR_HAVE_VM && !__linux__ */
+    (void)capacity;
+
+    return (vec->flags & VECTOR_FLAG_MAPPED) != 0;
+}
+
+static VectorResult vector_check_grow(const Vector *vec, const size_t count) {
+    if (count > SIZE_MAX / vec->elem_size - vec->elem_count) {
+        return VECTOR_OVERFLOW;
+    }
+
+    if (vector_storage_fixed(vec, vec->elem_count + count)) {
+        return VECTOR_UNSUPPORTED;
+    }
+
+    return VECTOR_OK;
+}
+
+VectorResult vector_try_reserve(Vector *vec, const size_t capacity) {
+    assert(vec);
+
+    if (capacity <= vec->capacity) {
+        return VECTOR_OK;
+    }
+
+    if (capacity > SIZE_MAX / vec->elem_size) {
+        return VECTOR_OVERFLOW;
+    }
+
+    if (vector_storage_fixed(vec, capacity)) {
+        return VECTOR_UNSUPPORTED;
+    }
+
+    return vector_storage_resize(vec, capacity) ? VECTOR_OK : VECTOR_OOM;
+}
+
+VectorResult vector_try_push_back(Vector *vec, const void *elem) {
+    assert(vec && elem);
+
+    const VectorResult res = vector_check_grow(vec, 1);
+    if (res != VECTOR_OK) {
+        return res;
+    }
+
+    return vector_push_back(vec, elem) ? VECTOR_OK : VECTOR_OOM;
+}
+
+VectorResult vector_try_append_n(Vector *vec, const void *src, const size_t count) {
+    assert(vec && (src || count == 0));
+
+    const VectorResult res = vector_check_grow(vec, count);
+    if (res != VECTOR_OK) {
+        return res;
+    }
+
+    return vector_append_n(vec, src, count) ? VECTOR_OK : VECTOR_OOM;
+}
+
+VectorResult vector_try_insert(Vector *vec, const size_t at, const void *src) {
+    assert(vec && src);
+
+    if (at > vec->elem_count) {
+        return VECTOR_OUT_OF_RANGE;
+    }
+
+    const VectorResult res = vector_check_grow(vec, 1);
+    if (res != VECTOR_OK) {
+        return res;
+    }
+
+    return vector_insert(vec, at, src) ? VECTOR_OK : VECTOR_OOM;
+}
+
+VectorResult vector_try_erase(Vector *vec, const size_t at) {
+    assert(vec);
+
+    if (at >= vec->elem_count) {
+        return VECTOR_OUT_OF_RANGE;
+    }
+
+    if (vector_storage_fixed(vec, 0)) {
+        return VECTOR_UNSUPPORTED;
+    }
+
+    return vector_erase(vec, at) ? VECTOR_OK : VECTOR_OOM;
+}
+
+VectorResult vector_try_pop_back(Vector *vec, void *out) {
+    assert(vec && out);
+
+    if (vec->elem_count == 0) {
+        return VECTOR_OUT_OF_RANGE;
+    }
+
+    vector_pop_back_into(vec, out);
+
+    return VECTOR_OK;
+}
+
+VectorResult vector_try_at(const Vector *vec, const size_t idx, void **out) {
+    assert(vec && out);
+
+    if (idx >= vec->elem_count) {
+        return VECTOR_OUT_OF_RANGE;
+    }
+
+    *out = (char *)vec->value + idx * vec->elem_size;
+
+    return VECTOR_OK;
+}
+
+#define VECTOR_FILE_MAGIC "CVECTOR"
+#define VECTOR_FILE_VERSION 1u
+#define VECTOR_FILE_BYTE_ORDER 0x01020304u
+
+/* Bytes vector_read allocates before doubling, so a corrupt count cannot force a huge allocation. */
+#define VECTOR_READ_CHUNK (1u << 20)
+
+typedef struct VectorFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t elem_size;
+    uint64_t elem_count;
+    uint64_t alignment;
+    uint64_t data_offset;
+    uint64_t checksum;
+} VectorFileHeader;
+
+/* Multiply-xor hash over four independent lanes, so it runs at memory speed. */
+static uint64_t vector_checksum(const void *data, const size_t bytes) {
+    const uint64_t prime = UINT64_C(0x9E3779B97F4A7C15);
+    const unsigned char *ptr = (const unsigned char *)data;
+    uint64_t lanes[4] = { 1, 2, 3, 4 };
+    size_t i = 0;
+
+    for (; i + 32 <= bytes; i += 32) {
+        for (size_t lane = 0; lane < 4; ++lane) {
+            uint64_t word;
+            memcpy(&word, ptr + i + lane * 8, sizeof(word));
+            lanes[lane] = (lanes[lane] ^ word) * prime;
+            lanes[lane] ^= lanes[lane] >> 29;
+        }
+    }
+
+    uint64_t hash = (uint64_t)bytes * prime;
+    for (size_t lane = 0; lane < 4; ++lane) {
+        hash = (hash ^ lanes[lane]) * prime;
+        hash ^= hash >> 29;
+    }
+
+    for (; i < bytes; ++i) {
+        hash = (hash ^ ptr[i]) * prime;
+    }
+
+    return hash ^ (hash >> 32);
+}
+
+static uint64_t vector_file_data_offset(const uint64_t alignment) {
+    return alignment > 64 ? alignment : 64;
+}
+
+static bool vector_file_header_valid(const VectorFileHeader *header, const uint64_t file_size) {
+    if (memcmp(header->magic, VECTOR_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != VECTOR_FILE_VERSION ||
+        header->byte_order != VECTOR_FILE_BYTE_ORDER ||
+        header->elem_size == 0 || header->elem_size > SIZE_MAX ||
+        (header->alignment & (header->alignment - 1)) != 0 || header->alignment > SIZE_MAX ||
+        header->data_offset != vector_file_data_offset(header->alignment) ||
+        header->elem_count > SIZE_MAX / header->elem_size) {
+        return false;
+    }
+
+    const uint64_t bytes = header->elem_count * header->elem_size;
+
+    return header->data_offset <= file_size && bytes <= file_size - header->data_offset;
+}
+
+bool vector_write(const Vector *vec, FILE *file) {
+    assert(vec && file);
+
+    static const unsigned char zeros[64];
+    const size_t bytes = vec->elem_count * vec->elem_size;
+    VectorFileHeader header;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, VECTOR_FILE_MAGIC, sizeof(header.magic));
+    header.version = VECTOR_FILE_VERSION;
+    header.byte_order = VECTOR_FILE_BYTE_ORDER;
+    header.elem_size = vec->elem_size;
+    header.elem_count = vec->elem_count;
+    header.alignment = vec->alignment;
+    header.data_offset = vector_file_data_offset(vec->alignment);
+    header.checksum = vector_checksum(vec->value, bytes);
+
+    if (fwrite(&header, sizeof(header), 1, file) != 1) {
+        return false;
+    }
+
+    for (uint64_t pad = header.data_offset - sizeof(header); pad > 0;) {
+        const size_t chunk = pad < sizeof(zeros) ? (size_t)pad : sizeof(zeros);
+        if (fwrite(zeros, 1, chunk, file) != chunk) {
+            return false;
+        }
+        pad -= chunk;
+    }
+
+    return bytes == 0 || fwrite(vec->value, 1, bytes, file) == bytes;
+}
+
+Vector *vector_read(FILE *file, void (*destructor)(void *)) {
+    assert(file);
+
+    unsigned char skip[64];
+    VectorFileHeader header;
+
+    if (fread(&header, sizeof(header), 1, file) != 1 || !vector_file_header_valid(&header, UINT64_MAX)) {
+        return NULL;
+    }
+
+    for (uint64_t pad = header.data_offset - sizeof(header); pad > 0;) {
+        const size_t chunk = pad < sizeof(skip) ? (size_t)pad : sizeof(skip);
+        if (fread(skip, 1, chunk, file) != chunk) {
+            return NULL;
+        }
+        pad -= chunk;
+    }
+
+    const size_t count = (size_t)header.elem_count;
+    const size_t elem_size = (size_t)header.elem_size;
+    const size_t chunk = VECTOR_READ_CHUNK / elem_size > 0 ? VECTOR_READ_CHUNK / elem_size : 1;
+
+    /* A stream has no known size to check the count against: grow as the data arrives. */
+    Vector *vec = vector_create_internal(count < chunk ? count : chunk, elem_size, NULL, NULL, (size_t)header.alignment);
+    if (NULL == vec) {
+        return NULL;
+    }
+
+    while (vec->elem_count < count) {
+        if (vec->elem_count == vec->capacity) {
+            const size_t grown = vec->capacity < count - vec->capacity ? 2 * vec->capacity : count;
+            if (!vector_storage_resize(vec, grown)) {
+                vector_destroy(vec);
+                return NULL;
+            }
+        }
+
+        const size_t want = (count < vec->capacity ? count : vec->capacity) - vec->elem_count;
+        if (fread((char *)vec->value + vec->elem_count * elem_size, elem_size, want, file) != want) {
+            vector_destroy(vec);
+            return NULL;
+        }
+        vec->elem_count += want;
+    }
+
+    if (count > 0 && vector_checksum(vec->value, count * elem_size) != header.checksum) {
+        vector_destroy(vec);
+        return NULL;
+    }
+
+    /* Set last, so a failed read destroys no elements. */
+    vec->destructor = destructor;
+
+    return vec;
+}
+
+#ifdef VECTOR_HAVE_VM
+/* Read and validate the header, then map the data region read-only. */
+static bool vector_file_map(const char *path, VectorFileHeader *header, void **value, size_t *mapped) {
+    *value = NULL;
+    *mapped = 0;
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (INVALID_HANDLE_VALUE == file) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    DWORD got = 0;
+    if (!GetFileSizeEx(file, &size) || !ReadFile(file, header, sizeof(*header), &got, NULL) ||
+        got != sizeof(*header) || !vector_file_header_valid(header, (uint64_t)size.QuadPart)) {
+        CloseHandle(file);
+        return false;
+    }
+#else
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || pread(fd, header, sizeof(*header), 0) != (ssize_t)sizeof(*header) ||
+        !vector_file_header_valid(header, (uint64_t)st.st_size)) {
+        close(fd);
+        return false;
+    }
+#endif /* _WIN32 */
+
+    const size_t bytes = (size_t)(header->elem_count * header->elem_size);
+    const size_t map_offset = (size_t)header->data_offset & ~(vector_map_granularity() - 1);
+    const size_t skip = (size_t)header->data_offset - map_offset;
+    void *base = NULL;
+
+    if (bytes > 0 && bytes <= SIZE_MAX - skip) {
+#if defined(_WIN32)
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping) {
+            base = MapViewOfFile(mapping, FILE_MAP_READ,
+                                 (DWORD)((uint64_t)map_offset >> 32), (DWORD)map_offset, skip + bytes);
+            CloseHandle(mapping);
+        }
+#else
+        base = mmap(NULL, skip + bytes, PROT_READ, MAP_SHARED, fd, (off_t)map_offset);
+        if (base == MAP_FAILED) {
+            base = NULL;
+        }
+#endif /* _WIN32 */
+    }
+
+#if defined(_WIN32)
+    CloseHandle(file);
+#else
+    close(fd);
+#endif /* _WIN32 */
+
+    if (bytes == 0) {
+        return true;
+    }
+
+    if (NULL == base) {
+        return false;
+    }
+
+    *value = (char *)base + skip;
+    *mapped = skip + bytes;
+
+    return true;
+}
+#endif /* VECTOR_HAVE_VM */
+
+Vector *vector_map_file(const char *path, const bool verify) {
+    assert(path);
+
+#ifdef VECTOR_HAVE_VM
+    VectorFileHeader header;
+    void *value = NULL;
+    size_t mapped = 0;
+
+    if (!vector_file_map(path, &header, &value, &mapped)) {
+        return NULL;
+    }
+
+    const size_t elem_size = (size_t)header.elem_size;
+    const size_t alignment = (size_t)header.alignment;
+
+    if (NULL == value) {
+        return vector_create_internal(0, elem_size, NULL, NULL, alignment);
+    }
+
+    const size_t bytes = (size_t)header.elem_count * elem_size;
+    if ((alignment && ((uintptr_t)value & (alignment - 1)) != 0) ||
+        (verify && vector_checksum(value, bytes) != header.checksum)) {
+        vector_file_unmap(value, mapped);
+        return NULL;
+    }
+
+    const VectorAllocator *allocator = &vector_default_allocator;
+    Vector *vec = (Vector *)vector_mem_alloc(allocator, sizeof(struct Vector));
+    if (NULL == vec) {
+        vector_file_unmap(value, mapped);
+        return NULL;
+    }
+
+    vec->value = value;
+    vec->capacity = (size_t)header.elem_count;
+    vec->elem_size = elem_size;
+    vec->elem_count = (size_t)header.elem_count;
+    vec->destructor = NULL;
+    vec->destroy_range = NULL;
+    vec->allocator = allocator;
+    vec->growth = vector_default_growth;
+    vec->flags = VECTOR_FLAG_MAPPED;
+    vec->inline_value = NULL;
+    vec->inline_capacity = 0;
+    vec->alignment = alignment;
+    vec->head = 0;
+    vec->vm_reserved = mapped;
+    vec->shared = NULL;
+
+    VECTOR_STATS_REGISTER(vec);
+
+    return vec;
+#else
+    (void)verify;
+
+    FILE *file = fopen(path, "rb");
+    if (NULL == file) {
+        return NULL;
+    }
+
+    Vector *vec = vector_read(file, NULL);
+    fclose(file);
+
+    return vec;
+#endif /* VECTOR_HAVE_VM */
+}
+
+static size_t vector_key_width(const VectorKeyType type) {
+    return (type == VECTOR_KEY_U32 || type == VECTOR_KEY_I32 || type == VECTOR_KEY_F32) ? 4 : 8;
+}
+
+/* Map a key to an unsigned integer with the same ordering. */
+static uint64_t vector_key_bits(const void *key, const VectorKeyType type) {
+    uint32_t u32;
+    uint64_t u64;
+
+    switch (type) {
+    case VECTOR_KEY_U32:
+        memcpy(&u32, key, sizeof(u32));
+        return u32;
+    case VECTOR_KEY_I32:
+        memcpy(&u32, key, sizeof(u32));
+        return u32 ^ UINT32_C(0x80000000);
+    case VECTOR_KEY_F32:
+        memcpy(&u32, key, sizeof(u32));
+        return (u32 & UINT32_C(0x80000000)) ? ~u32 : (u32 | UINT32_C(0x80000000));
+    case VECTOR_KEY_U64:
+        memcpy(&u64, key, sizeof(u64));
+        return u64;
+    case VECTOR_KEY_I64:
+        memcpy(&u64, key, sizeof(u64));
+        return u64 ^ UINT64_C(0x8000000000000000);
+    case VECTOR_KEY_F64:
+        memcpy(&u64, key, sizeof(u64));
+        return (u64 & UINT64_C(0x8000000000000000)) ? ~u64 : (u64 | UINT64_C(0x8000000000000000));
+    case VECTOR_KEY_NONE:
+        break;
+    }
+
+    return 0;
+}
+
+static void vector_copy_elem(void *dst, const void *src, const size_t elem_size) {
+    /* Fixed-size branches let the compiler emit single loads/stores. */
+    if (elem_size == 8) {
+        memcpy(dst, src, 8);
+    } else if (elem_size == 4) {
+        memcpy(dst, src, 4);
+    } else if (elem_size == 16) {
+        memcpy(dst, src, 16);
+    } else {
+        memcpy(dst, src, elem_size);
+    }
+
+    return;
+}
+
+/* Rewrite keys in place so that unsigned comparison matches key order. */
+static void vector_key_encode(Vector *vec, const VectorKeyType type, const size_t offset, const bool decode) {
+    char *key = (char *)vec->value + offset;
+
+    if (type == VECTOR_KEY_U32 || type == VECTOR_KEY_U64) {
+        return;
+    }
+
+    for (size_t i = 0; i < vec->elem_count; ++i, key += vec->elem_size) {
+        uint32_t u32;
+        uint64_t u64;
+
+        switch (type) {
+        case VECTOR_KEY_I32:
+            memcpy(&u32, key, sizeof(u32));
+            u32 ^= UINT32_C(0x80000000);
+            memcpy(key, &u32, sizeof(u32));
+            break;
+        case VECTOR_KEY_F32:
+            memcpy(&u32, key, sizeof(u32));
+            if (decode) {
+                u32 = (u32 & UINT32_C(0x80000000)) ? (u32 & ~UINT32_C(0x80000000)) : ~u32;
+            } else {
+                u32 = (u32 & UINT32_C(0x80000000)) ? ~u32 : (u32 | UINT32_C(0x80000000));
+            }
+            memcpy(key, &u32, sizeof(u32));
+            break;
+        case VECTOR_KEY_I64:
+            memcpy(&u64, key, sizeof(u64));
+            u64 ^= UINT64_C(0x8000000000000000);
+            memcpy(key, &u64, sizeof(u64));
+            break;
+        case VECTOR_KEY_F64:
+            memcpy(&u64, key, sizeof(u64));
+            if (decode) {
+                u64 = (u64 & UINT64_C(0x8000000000000000)) ? (u64 & ~UINT64_C(0x8000000000000000)) : ~u64;
+            } else {
+                u64 = (u64 & UINT64_C(0x8000000000000000)) ? ~u64 : (u64 | UINT64_C(0x8000000000000000));
+            }
+            memcpy(key, &u64, sizeof(u64));
+            break;
+        default:
+            break;
+        }
+    }
+
+    return;
+}
+
+static uint64_t vector_radix_key(const char *key, const size_t width) {
+    if (width == 8) {
+        uint64_t u64;
+        memcpy(&u64, key, sizeof(u64));
+        return u64;
+    }
+
+    uint32_t u32;
+    memcpy(&u32, key, sizeof(u32));
+
+    return u32;
+}
+
+/*
+ * Stable LSD radix sort on 8-bit digits of encoded keys, skipping
+ * digits shared by all keys.
+ */
+static bool vector_radix_sort(Vector *vec, const VectorKeyType type, const size_t offset) {
+    const size_t count = vec->elem_count;
+    const size_t elem_size = vec->elem_size;
+    const size_t width = vector_key_width(type);
+    size_t histogram[8][256];
+
+    char *scratch = (char *)vector_mem_alloc(vec->allocator, count * elem_size);
+    if (NULL == scratch) {
+        return false;
+    }
+
+    vector_key_encode(vec, type, offset, false);
+
+    memset(histogram, 0, sizeof(histogram));
+    for (size_t i = 0; i < count; ++i) {
+        const uint64_t bits = vector_radix_key((char *)vec->value + i * elem_size + offset, width);
+        for (size_t pass = 0; pass < width; ++pass) {
+            ++histogram[pass][(bits >> (pass * 8)) & 0xff];
+        }
+    }
+
+    char *src = (char *)vec->value;
+    char *dst = scratch;
+
+    for (size_t pass = 0; pass < width; ++pass) {
+        size_t *buckets = histogram[pass];
+        const size_t shift = pass * 8;
+        if (buckets[(vector_radix_key(src + offset, width) >> shift) & 0xff] == count) {
+            continue;
+        }
+
+        size_t sum = 0;
+        for (size_t digit = 0; digit < 256; ++digit) {
+            const size_t n = buckets[digit];
+            buckets[digit] = sum;
+            sum += n;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            const char *elem = src + i * elem_size;
+            const size_t digit = (vector_radix_key(elem + offset, width) >> shift) & 0xff;
+            vector_copy_elem(dst + buckets[digit]++ * elem_size, elem, elem_size);
+        }
+
+        char *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    if (src != vec->value) {
+        memcpy(vec->value, src, count * elem_size);
+    }
+
+    vector_mem_free(vec->allocator, scratch, count * elem_size);
+
+    vector_key_encode(vec, type, offset, true);
+
+    return true;
+}
+
+/* Branchless search: first index whose key is >= bits (or > bits if upper). */
+static size_t vector_key_bound(const Vector *vec, const uint64_t bits, const VectorOrder *order, const bool upper) {
+    const size_t elem_size = vec->elem_size;
+    const char *base = (const char *)vec->value + order->key_offset;
+    size_t n = vec->elem_count;
+
+    if (n == 0) {
+        return 0;
+    }
+
+    while (n > 1) {
+        const size_t half = n / 2;
+        const uint64_t mid = vector_key_bits(base + half * elem_size, order->key_type);
+        base = (upper ? mid <= bits : mid < bits) ? base + half * elem_size : base;
+        n -= half;
+    }
+
+    const uint64_t last = vector_key_bits(base, order->key_type);
+    const size_t idx = (size_t)(base - ((const char *)vec->value + order->key_offset)) / elem_size;
+
+    return idx + (upper ? last <= bits : last < bits);
+}
+
+static size_t vector_cmp_bound(const Vector *vec, const void *probe, const VectorOrder *order, const bool upper) {
+    size_t lo = 0;
+    size_t hi = vec->elem_count;
+
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        const int res = order->cmp(probe, (const char *)vec->value + mid * vec->elem_size);
+        if (upper ? res >= 0 : res > 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+bool vector_sort(Vector *vec, const VectorOrder *order) {
+    assert(vec && order);
+    assert(order->key_type != VECTOR_KEY_NONE || order->cmp);
+    assert(order->key_type == VECTOR_KEY_NONE ||
+           order->key_offset + vector_key_width(order->key_type) <= vec->elem_size);
+
+    if (vec->elem_count < 2) {
+        return true;
+    }
+
+    if (!VECTOR_OWN(vec)) {
+        return false;
+    }
+
+    if (order->key_type == VECTOR_KEY_NONE) {
+        qsort(vec->value, vec->elem_count, vec->elem_size, order->cmp);
+        return true;
+    }
+
+    return vector_radix_sort(vec, order->key_type, order->key_offset);
+}
+
+size_t vector_lower_bound(const Vector *vec, const void *probe, const VectorOrder *order) {
+    assert(vec && probe && order);
+
+    if (order->key_type == VECTOR_KEY_NONE) {
+        assert(order->cmp);
+        return vector_cmp_bound(vec, probe, order, false);
+    }
+
+    return vector_key_bound(vec, vector_key_bits(probe, order->key_type), order, false);
+}
+
+bool vector_binary_search(const Vector *vec, const void *probe, const VectorOrder *order, size_t *out_idx) {
+    assert(vec && probe && order);
+
+    const size_t idx = vector_lower_bound(vec, probe, order);
+    bool found = false;
+
+    if (idx < vec->elem_count) {
+        const char *elem = (const char *)vec->value + idx * vec->elem_size;
+        if (order->key_type == VECTOR_KEY_NONE) {
+            found = order->cmp(probe, elem) == 0;
+        } else {
+            found = vector_key_bits(elem + order->key_offset, order->key_type) ==
+                    vector_key_bits(probe, order->key_type);
+        }
+    }
+
+    if (out_idx) {
+        *out_idx = idx;
+    }
+
+    return found;
+}
+
+void *vector_insert_sorted(Vector *vec, const void *elem, const VectorOrder *order) {
+    assert(vec && elem && order);
+
+    size_t at = 0;
+    if (order->key_type == VECTOR_KEY_NONE) {
+        assert(order->cmp);
+        at = vector_cmp_bound(vec, elem, order, true);
+    } else {
+        const uint64_t bits = vector_key_bits((const char *)elem + order->key_offset, order->key_type);
+        at = vector_key_bound(vec, bits, order, true);
+    }
+
+    void *slot = vector_open_gap(vec, at, 1);
+    if (NULL == slot) {
+        return NULL;
+    }
+
+    memcpy(slot, elem, vec->elem_size);
+
+    return slot;
+}
+
+#ifdef VECTOR_STATS
+void vector_get_stats(const Vector *vec, VectorStats *out) {
+    assert(vec && out);
+
+    *out = vec->stats;
+    out->wasted_bytes = (vec->capacity - vec->elem_count) * vec->elem_size;
+
+    return;
+}
+
+void vector_stats_set_label(Vector *vec, const char *label) {
+    assert(vec);
+
+    vec->stats.label = label;
+
+    return;
+}
+
+void vector_stats_foreach(void (*fn)(const Vector *vec, const VectorStats *stats, void *ctx), void *ctx) {
+    assert(fn);
+
+    VECTOR_REGISTRY_LOCK();
+    for (const Vector *vec = vector_registry; vec; vec = vec->stats_next) {
+        VectorStats stats;
+        vector_get_stats(vec, &stats);
+        fn(vec, &stats, ctx);
+    }
+    VECTOR_REGISTRY_UNLOCK();
+
+    return;
+}
+
+void vector_stats_set_growth_hook(VectorGrowthHook hook, void *ctx) {
+    VECTOR_REGISTRY_LOCK();
+    vector_growth_hook_ctx = ctx;
+    vector_growth_hook = hook;
+    VECTOR_REGISTRY_UNLOCK();
+
+    return;
 }
+#endif /* VECTOR_STATS */
@@ -10,6 +10,11 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdio.h>
+
+#if defined(VECTOR_EXPOSE_LAYOUT) && !defined(VECTOR_BUILD)
+#include <assert.h>
+#endif /* VECTOR_EXPOSE_LAYOUT */
 
 /* Set up for C function definitions, even when using C++ */
 #ifdef __cplusplus
@@ -17,14 +22,248 @@ extern "C" {
 #endif
 
     /**
-     * @brief Opaque handle to a dynamically-sized contiguous array.
+     * @brief Handle to a dynamically-sized contiguous array.
      *
      * The Vector owns its storage. Elements are stored densely and
      * addressed by index. Reallocation may invalidate pointers
      * previously obtained via vector_at, vector_begin, etc.
+     *
+     * The layout is opaque unless VECTOR_EXPOSE_LAYOUT is defined
+     * before including this header, in which case struct Vector can
+     * be embedded in other structures (see vector_init) and the
+     * element accessors are provided as static inline functions.
      */
     typedef struct Vector Vector;
 
+    /**
+     * @brief Memory allocator used for a vector's header and storage.
+     *
+     * Every callback receives ctx as its first argument, along with
+     * the size of the block involved so that sized allocators
+     * (arenas, pools) need no bookkeeping of their own.
+     *
+     * The allocator is referenced, not copied: it must outlive every
+     * vector created with it, including clones.
+     */
+    typedef struct VectorAllocator {
+        /** Allocate size bytes. Required. */
+        void *(*allocate)(void *ctx, size_t size);
+        /** Resize a block. May be NULL, in which case allocate + copy + deallocate is used. */
+        void *(*reallocate)(void *ctx, void *ptr, size_t old_size, size_t new_size);
+        /** Release a block. May be NULL for allocators freed in one shot (e.g. arenas). */
+        void (*deallocate)(void *ctx, void *ptr, size_t size);
+        /** User context passed to every callback. */
+        void *ctx;
+    } VectorAllocator;
+
+    /**
+     * @brief Strategy used to compute a new capacity when a vector
+     *        runs out of room.
+     */
+    typedef enum VectorGrowthKind {
+        VECTOR_GROWTH_DOUBLE = 0, /**< capacity * 2 (default). */
+        VECTOR_GROWTH_HALF,       /**< capacity * 1.5. */
+        VECTOR_GROWTH_LINEAR,     /**< capacity + increment. */
+        VECTOR_GROWTH_CUSTOM      /**< Result of the grow callback. */
+    } VectorGrowthKind;
+
+    /**
+     * @brief Per-vector growth policy.
+     *
+     * Whatever the strategy, the new capacity is always at least what
+     * the triggering operation requires, and never exceeds the largest
+     * capacity whose byte size fits in a size_t.
+     */
+    typedef struct VectorGrowthPolicy {
+        /** Growth strategy. */
+        VectorGrowthKind kind;
+        /** Elements added per growth for VECTOR_GROWTH_LINEAR. */
+        size_t increment;
+        /** If non-zero, upper bound on elements added per growth. */
+        size_t max_step;
+        /**
+         * Round the byte size of each growth up to the allocator's
+         * size classes, and use any slack the default allocator
+         * reports, so no allocated space goes unused.
+         */
+        bool round_to_size_class;
+        /**
+         * Callback for VECTOR_GROWTH_CUSTOM. Receives the current
+         * capacity, the required capacity and the element size, and
+         * returns the new capacity in elements.
+         */
+        size_t (*grow)(size_t capacity, size_t required, size_t elem_size, void *ctx);
+        /** User context passed to grow. */
+        void *ctx;
+    } VectorGrowthPolicy;
+
+    /**
+     * @brief Outcome of the vector_try_* functions.
+     */
+    typedef enum VectorResult {
+        VECTOR_OK = 0,         /**< Success. */
+        VECTOR_OOM,            /**< Storage could not be allocated; the vector is unchanged. */
+        VECTOR_OVERFLOW,       /**< The requested size in bytes does not fit in size_t. */
+        VECTOR_OUT_OF_RANGE,   /**< Index past the end, or pop from an empty vector. */
+        /**
+         * The storage cannot change this way by design: it maps a file
+         * read-only, or is a reserved vector at the end of its
+         * reservation on a platform that cannot move it. Retrying or
+         * freeing memory will not help; vector_clone gives a vector
+         * that can.
+         */
+        VECTOR_UNSUPPORTED
+    } VectorResult;
+
+    /**
+     * @brief Fixed-width key types with a specialized sort/search path.
+     */
+    typedef enum VectorKeyType {
+        VECTOR_KEY_NONE = 0, /**< No key: use the comparator. */
+        VECTOR_KEY_U32,      /**< uint32_t */
+        VECTOR_KEY_I32,      /**< int32_t */
+        VECTOR_KEY_F32,      /**< float */
+        VECTOR_KEY_U64,      /**< uint64_t */
+        VECTOR_KEY_I64,      /**< int64_t */
+        VECTOR_KEY_F64       /**< double */
+    } VectorKeyType;
+
+    /**
+     * @brief Ordering used by the sort and search functions.
+     *
+     * With a key type, elements are ordered by the fixed-width key
+     * stored key_offset bytes into each element: sorting is a stable
+     * radix sort and searches are branchless. Otherwise cmp is used,
+     * with qsort semantics for sorting.
+     *
+     * Search probes are keys, as with bsearch: with a key type the
+     * probe points to a value of that type, otherwise it is passed as
+     * the first argument of cmp.
+     */
+    typedef struct VectorOrder {
+        VectorKeyType key_type;                   /**< Key type, or VECTOR_KEY_NONE. */
+        size_t key_offset;                        /**< Byte offset of the key in an element. */
+        int (*cmp)(const void *a, const void *b); /**< Comparator when key_type is NONE. */
+    } VectorOrder;
+
+#ifdef VECTOR_STATS
+    /**
+     * @brief Per-vector instrumentation counters (VECTOR_STATS builds).
+     */
+    typedef struct VectorStats {
+        size_t reallocations;  /**< Storage reallocations (growth and shrink). */
+        size_t bytes_moved;    /**< Bytes shifted by memmove in insert/erase. */
+        size_t peak_capacity;  /**< Largest capacity reached, in elements. */
+        size_t wasted_bytes;   /**< Unused capacity in bytes at query time. */
+        const char *label;     /**< Label set with vector_stats_set_label, or NULL. */
+    } VectorStats;
+
+    /**
+     * @brief Callback fired whenever a vector's storage grows.
+     */
+    typedef void (*VectorGrowthHook)(const Vector *vec,
+                                     size_t old_capacity,
+                                     size_t new_capacity,
+                                     void *ctx);
+#endif /* VECTOR_STATS */
+
+#if defined(VECTOR_EXPOSE_LAYOUT) || defined(VECTOR_BUILD)
+    /**
+     * @brief Vector layout.
+     *
+     * Fields are read-only for users: mutate only through the API.
+     * The layout depends on VECTOR_STATS, which must be defined
+     * consistently across the library and its users.
+     */
+    struct Vector {
+        void *value;                        /**< Element storage. */
+        size_t elem_size;                   /**< Size of one element in bytes. */
+        size_t elem_count;                  /**< Number of stored elements. */
+        size_t capacity;                    /**< Capacity in elements, counted from value. */
+        size_t head;                        /**< Free slots before value, left by the front operations. */
+        void (*destructor)(void *);         /**< Optional per-element destructor. */
+        void (*destroy_range)(void *, size_t); /**< Optional batch destructor, preferred over destructor. */
+        const VectorAllocator *allocator;   /**< Allocator for header and storage. */
+        VectorGrowthPolicy growth;          /**< Growth policy. */
+        unsigned flags;                     /**< Internal state flags. */
+        void *inline_value;                 /**< Inline or caller-provided buffer, if any. */
+        size_t inline_capacity;             /**< Capacity of inline_value in elements. */
+        size_t alignment;                   /**< Storage alignment, or 0 for the allocator's. */
+        size_t vm_reserved;                 /**< Reserved or mapped bytes for VM-backed storage. */
+        struct VectorShared *shared;        /**< Copy-on-write control block while storage is shared, or NULL. */
+#ifdef VECTOR_STATS
+        VectorStats stats;                  /**< Instrumentation counters. */
+        Vector *stats_prev;                 /**< Previous vector in the global registry. */
+        Vector *stats_next;                 /**< Next vector in the global registry. */
+#endif /* VECTOR_STATS */
+    };
+#endif /* VECTOR_EXPOSE_LAYOUT || VECTOR_BUILD */
+
+#if defined(VECTOR_EXPOSE_LAYOUT) && !defined(VECTOR_BUILD)
+    /*
+     * Inline accessors. They are defined before the extern
+     * declarations below, which then refer to these definitions.
+     */
+
+    static inline void *vector_at(const Vector *vec, size_t idx) {
+        assert(vec && idx < vec->elem_count);
+
+        return (char *)vec->value + idx * vec->elem_size;
+    }
+
+    static inline void *vector_at_unchecked(const Vector *vec, size_t idx) {
+        return (char *)vec->value + idx * vec->elem_size;
+    }
+
+    static inline void *vector_front(const Vector *vec) {
+        assert(vec && vec->elem_count > 0);
+
+        return vec->value;
+    }
+
+    static inline void *vector_back(const Vector *vec) {
+        assert(vec && vec->elem_count > 0);
+
+        return (char *)vec->value + (vec->elem_count - 1) * vec->elem_size;
+    }
+
+    static inline size_t vector_size(const Vector *vec) {
+        assert(vec);
+
+        return vec->elem_count;
+    }
+
+    static inline size_t vector_capacity(const Vector *vec) {
+        assert(vec);
+
+        return vec->capacity;
+    }
+
+    static inline bool vector_is_empty(const Vector *vec) {
+        assert(vec);
+
+        return vec->elem_count == 0;
+    }
+
+    static inline void *vector_begin(const Vector *vec) {
+        assert(vec);
+
+        return vec->value;
+    }
+
+    static inline void *vector_end(const Vector *vec) {
+        assert(vec);
+
+        return (char *)vec->value + vec->elem_count * vec->elem_size;
+    }
+
+    static inline void *vector_data(const Vector *vec) {
+        assert(vec);
+
+        return vec->value;
+    }
+#endif /* VECTOR_EXPOSE_LAYOUT && !VECTOR_BUILD */
+
     /**
      * @brief Helper macro to iterate over all elements of a vector.
      *
@@ -62,16 +301,213 @@ extern "C" {
                                size_t elem_size,
                                void (*destructor)(void *));
 
+    /**
+     * @brief Create a new vector backed by a custom allocator.
+     *
+     * Both the vector itself and its element storage are obtained
+     * from the allocator. Clones share the allocator of their source.
+     *
+     * @param capacity   Initial number of elements to reserve.
+     *                   If zero, a minimum capacity is allocated.
+     * @param elem_size  Size in bytes of a single element.
+     * @param destructor Optional per-element destructor. May be NULL.
+     * @param allocator  Allocator to use, or NULL for malloc/realloc/free.
+     *
+     * @return Pointer to a new Vector, or NULL on allocation failure.
+     */
+    extern Vector *vector_create_with_allocator(size_t capacity,
+                                                size_t elem_size,
+                                                void (*destructor)(void *),
+                                                const VectorAllocator *allocator);
+
+    /**
+     * @brief Create a new vector with over-aligned storage.
+     *
+     * vector_data is aligned to alignment bytes for the lifetime of
+     * the vector, across growth, vector_shrink_to_fit and into clones.
+     * The vector header itself is cache-line aligned and padded so it
+     * never shares a cache line with other data.
+     *
+     * @param capacity   Initial number of elements to reserve.
+     *                   If zero, a minimum capacity is allocated.
+     * @param elem_size  Size in bytes of a single element.
+     * @param alignment  Storage alignment in bytes (power of two).
+     * @param destructor Optional per-element destructor. May be NULL.
+     *
+     * @return Pointer to a new Vector, or NULL on allocation failure.
+     */
+    extern Vector *vector_create_aligned(size_t capacity,
+                                         size_t elem_size,
+                                         size_t alignment,
+                                         void (*destructor)(void *));
+
+    /**
+     * @brief Create a new vector backed by reserved virtual memory.
+     *
+     * Address space for max_capacity elements is reserved up front and
+     * pages are committed as the vector grows, so growth never copies
+     * elements and never holds two buffers at once. Within the
+     * reservation element pointers stay valid across growth.
+     * vector_shrink_to_fit returns the unused tail pages to the OS.
+     *
+     * On Linux, growing past max_capacity moves the committed pages
+     * into a larger reservation with mremap (no copy, but the address
+     * changes); elsewhere it fails like an allocation failure. Where
+     * virtual memory APIs are unavailable this is vector_create.
+     *
+     * Storage is page-aligned and bypasses any allocator; the header
+     * uses malloc. Clones are ordinary heap vectors.
+     *
+     * @param max_capacity Number of elements to reserve address space for.
+     * @param elem_size    Size in bytes of a single element.
+     * @param destructor   Optional per-element destructor. May be NULL.
+     *
+     * @return Pointer to a new Vector, or NULL on allocation failure.
+     */
+    extern Vector *vector_create_reserved(size_t max_capacity,
+                                          size_t elem_size,
+                                          void (*destructor)(void *));
+
+    /**
+     * @brief Create a new vector with inline storage for small sizes.
+     *
+     * The vector header and storage for the first capacity elements
+     * are obtained with a single allocation. Storage spills to the
+     * heap only when capacity is exceeded, and vector_shrink_to_fit
+     * moves it back inline once the elements fit again.
+     *
+     * @param capacity   Number of elements stored inline.
+     *                   If zero, a minimum capacity is allocated.
+     * @param elem_size  Size in bytes of a single element.
+     * @param destructor Optional per-element destructor. May be NULL.
+     *
+     * @return Pointer to a new Vector, or NULL on allocation failure.
+     */
+    extern Vector *vector_create_inline(size_t capacity,
+                                        size_t elem_size,
+                                        void (*destructor)(void *));
+
+#if defined(VECTOR_EXPOSE_LAYOUT) || defined(VECTOR_BUILD)
+    /**
+     * @brief Initialize a caller-owned vector header.
+     *
+     * Like vector_create, but the Vector lives wherever the caller
+     * puts it (stack, embedded in another struct). Release it with
+     * vector_deinit, not vector_destroy.
+     *
+     * @param vec        Header to initialize.
+     * @param capacity   Initial number of elements to reserve.
+     *                   If zero, a minimum capacity is allocated.
+     * @param elem_size  Size in bytes of a single element.
+     * @param destructor Optional per-element destructor. May be NULL.
+     *
+     * @return true on success, false on allocation failure.
+     */
+    extern bool vector_init(Vector *vec,
+                            size_t capacity,
+                            size_t elem_size,
+                            void (*destructor)(void *));
+
+    /**
+     * @brief Initialize a caller-owned vector over caller-provided storage.
+     *
+     * No allocation takes place until the buffer overflows, at which
+     * point storage spills to the heap. The buffer must outlive the
+     * vector and be suitably aligned for the element type. Release
+     * the vector with vector_deinit.
+     *
+     * @param vec        Header to initialize.
+     * @param buf        Storage for capacity elements.
+     * @param capacity   Capacity of buf in elements (must be non-zero).
+     * @param elem_size  Size in bytes of a single element.
+     * @param destructor Optional per-element destructor. May be NULL.
+     */
+    extern void vector_init_in_place(Vector *vec,
+                                     void *buf,
+                                     size_t capacity,
+                                     size_t elem_size,
+                                     void (*destructor)(void *));
+
+    /**
+     * @brief Release a vector set up with vector_init or vector_init_in_place.
+     *
+     * Calls the destructor on all stored elements (if provided) and
+     * frees heap storage. The header itself is left to the caller.
+     *
+     * @param vec Vector to release.
+     */
+    extern void vector_deinit(Vector *vec);
+#endif /* VECTOR_EXPOSE_LAYOUT || VECTOR_BUILD */
+
+    /**
+     * @brief Set the growth policy of a vector.
+     *
+     * The policy is copied. Clones inherit the policy of their source.
+     *
+     * @param vec    Vector to configure.
+     * @param policy Policy to apply, or NULL to restore the default
+     *               (doubling, no rounding).
+     */
+    extern void vector_set_growth_policy(Vector *vec, const VectorGrowthPolicy *policy);
+
+    /**
+     * @brief Set a batch destructor for a vector.
+     *
+     * When set, every operation that destroys elements calls
+     * destroy_range once per contiguous run instead of calling the
+     * per-element destructor on each element. Clones inherit it.
+     * Must not be called while vec shares copy-on-write storage.
+     *
+     * @param vec           Vector to configure.
+     * @param destroy_range Destroy count elements starting at first,
+     *                      or NULL to go back to the per-element destructor.
+     */
+    extern void vector_set_range_destructor(Vector *vec, void (*destroy_range)(void *first, size_t count));
+
     /**
      * @brief Destroy a vector and release all resources.
      *
      * Calls the destructor on all stored elements (if provided),
-     * then frees internal storage and the vector itself.
+     * then frees internal storage and the vector itself. With the
+     * thread cache enabled, a plain heap vector is kept for reuse by
+     * vector_create instead.
      *
      * @param vec Vector to destroy.
      */
     extern void vector_destroy(Vector *vec);
 
+    /**
+     * @brief Enable or resize the calling thread's vector cache.
+     *
+     * While enabled, vector_destroy keeps vectors created by
+     * vector_create or vector_create_with_allocator with the default
+     * allocator (and not aligned, inline, reserved or copy-on-write
+     * shared) in per-thread bins keyed by storage size, and
+     * vector_create hands them out again with their storage, so
+     * create/destroy cycles stop reaching the allocator. The cache is
+     * disabled (limit 0) by default. Cached memory is not released
+     * when a thread exits: call vector_thread_cache_set_limit(0)
+     * first.
+     *
+     * @param max_bytes Most bytes of headers and storage to retain;
+     *                  0 disables the cache. Excess is freed at once.
+     */
+    extern void vector_thread_cache_set_limit(size_t max_bytes);
+
+    /**
+     * @brief Free cached vectors of the calling thread, largest first.
+     *
+     * @param max_bytes Bytes to keep cached at most; 0 empties the cache.
+     */
+    extern void vector_thread_cache_trim(size_t max_bytes);
+
+    /**
+     * @brief Bytes currently retained by the calling thread's vector cache.
+     *
+     * @return Bytes of cached headers and storage.
+     */
+    extern size_t vector_thread_cache_bytes(void);
+
     /**
      * @brief Reset the vector size to zero.
      *
@@ -97,7 +533,8 @@ extern "C" {
     /**
      * @brief Append an element to the end of the vector.
      *
-     * Reallocates storage if capacity is exceeded.
+     * Reallocates storage according to the growth policy
+     * if capacity is exceeded.
      *
      * @param vec  Vector to append to.
      * @param elem Pointer to element data to copy into the vector.
@@ -107,12 +544,42 @@ extern "C" {
      */
     extern void *vector_push_back(Vector *vec, const void *elem);
 
+    /**
+     * @brief Append an uninitialized slot to the end of the vector.
+     *
+     * Reallocates storage according to the growth policy
+     * if capacity is exceeded. The element counts as stored as soon
+     * as this returns: the caller must construct it in place before
+     * the vector is read, cleared or destroyed.
+     *
+     * @param vec Vector to append to.
+     *
+     * @return Pointer to the new slot, or NULL on allocation failure.
+     */
+    extern void *vector_emplace_back(Vector *vec);
+
+    /**
+     * @brief Append count uninitialized slots to the end of the vector.
+     *
+     * Same contract as vector_emplace_back, for a run of elements:
+     * all count slots must be constructed in place by the caller.
+     *
+     * @param vec   Vector to append to.
+     * @param count Number of slots to append.
+     *
+     * @return Pointer to the first new slot, or NULL on allocation failure.
+     */
+    extern void *vector_push_uninit(Vector *vec, size_t count);
+
     /**
      * @brief Remove the last element of the vector.
      *
      * The element is copied into out_elem.
      * The destructor is NOT called.
      *
+     * Despite its type, out_elem is treated as a plain buffer of
+     * elem_size bytes; prefer vector_pop_back_into.
+     *
      * @param vec      Vector to pop from.
      * @param out_elem Destination buffer (must be at least elem_size bytes).
      *
@@ -120,6 +587,117 @@ extern "C" {
      */
     extern bool vector_pop_back(Vector *vec, void **out_elem);
 
+    /**
+     * @brief Remove the last element of the vector.
+     *
+     * The element is copied into out_elem.
+     * The destructor is NOT called.
+     *
+     * @param vec      Vector to pop from.
+     * @param out_elem Destination buffer (must be at least elem_size bytes).
+     *
+     * @return true on success, false otherwise.
+     */
+    extern bool vector_pop_back_into(Vector *vec, void *out_elem);
+
+    /**
+     * @brief Remove the last count elements of the vector.
+     *
+     * If out_elems is non-NULL the elements are copied into it in
+     * order and the destructor is NOT called. If it is NULL the
+     * elements are destroyed (destructor called, if provided).
+     *
+     * @param vec       Vector to pop from.
+     * @param count     Number of elements to remove (count <= size).
+     * @param out_elems Destination buffer of count * elem_size bytes, or NULL.
+     *
+     * @return true on success, false otherwise.
+     */
+    extern bool vector_pop_back_n(Vector *vec, size_t count, void *out_elems);
+
+    /**
+     * @brief Remove the last element of the vector without copying it.
+     *
+     * The destructor is NOT called: ownership of the element passes
+     * to the caller. The returned pointer stays valid until the next
+     * operation that modifies the vector.
+     *
+     * @param vec Vector to pop from (must not be empty).
+     *
+     * @return Pointer to the removed element.
+     */
+    extern void *vector_take_back(Vector *vec);
+
+    /**
+     * @brief Insert an element at the front of the vector.
+     *
+     * Amortized O(1): the vector keeps free slots in front of the
+     * first element, refilled by shifting the contents into the back
+     * half of the free space (growing first if there is too little)
+     * only when they run out. Storage stays contiguous, so
+     * vector_data and indexing work unchanged.
+     *
+     * @param vec  Vector to prepend to.
+     * @param elem Pointer to element data to copy into the vector.
+     *
+     * @return Pointer to the new first element,
+     *         or NULL on allocation failure.
+     */
+    extern void *vector_push_front(Vector *vec, const void *elem);
+
+    /**
+     * @brief Insert an uninitialized slot at the front of the vector.
+     *
+     * Same contract as vector_emplace_back.
+     *
+     * @param vec Vector to prepend to.
+     *
+     * @return Pointer to the new slot, or NULL on allocation failure.
+     */
+    extern void *vector_emplace_front(Vector *vec);
+
+    /**
+     * @brief Remove the first element of the vector in O(1).
+     *
+     * Equivalent to vector_pop_front_n(vec, 1, out_elem).
+     *
+     * @param vec      Vector to pop from (must not be empty).
+     * @param out_elem Destination buffer of elem_size bytes, or NULL.
+     *
+     * @return true on success, false otherwise.
+     */
+    extern bool vector_pop_front(Vector *vec, void *out_elem);
+
+    /**
+     * @brief Remove the first count elements of the vector without moving the rest.
+     *
+     * If out_elems is non-NULL the elements are copied into it in
+     * order and the destructor is NOT called. If it is NULL the
+     * elements are destroyed (destructor called, if provided). The
+     * freed slots are reused by vector_push_front, and by push_back
+     * once they outnumber the elements, or when the vector empties.
+     *
+     * @param vec       Vector to pop from.
+     * @param count     Number of elements to remove (count <= size).
+     * @param out_elems Destination buffer of count * elem_size bytes, or NULL.
+     *
+     * @return true on success, false otherwise.
+     */
+    extern bool vector_pop_front_n(Vector *vec, size_t count, void *out_elems);
+
+    /**
+     * @brief Move the elements to the start of the storage.
+     *
+     * Elements are always contiguous; this hands the free slots left
+     * in front of them by the front operations back to the end, so
+     * that vector_capacity covers the whole allocation.
+     *
+     * @param vec Vector to compact.
+     *
+     * @return Pointer to the first element, as vector_data.
+     */
+    extern void *vector_linearize(Vector *vec);
+
     /**
      * @brief Access an element by index.
      *
@@ -130,6 +708,19 @@ extern "C" {
      */
     extern void *vector_at(const Vector *vec, size_t idx);
 
+    /**
+     * @brief Access an element by index without any check.
+     *
+     * Never asserts, even in debug builds, for loops whose bounds
+     * are already known to hold.
+     *
+     * @param vec Vector to access.
+     * @param idx Index of element. Must be less than the size.
+     *
+     * @return Pointer to the element.
+     */
+    extern void *vector_at_unchecked(const Vector *vec, size_t idx);
+
     /**
      * @brief Access the first element.
      *
@@ -148,6 +739,19 @@ extern "C" {
      */
     extern void *vector_back(const Vector *vec);
 
+    /**
+     * @brief Hint that a range of elements is about to be read.
+     *
+     * Issues a prefetch for every cache line of the range so the loads
+     * overlap with work on earlier elements. Has no effect on buffer
+     * contents, and compiles to nothing without prefetch support.
+     *
+     * @param vec   Vector to prefetch from.
+     * @param first Index of the first element.
+     * @param count Number of elements (first + count <= size).
+     */
+    extern void vector_prefetch_range(const Vector *vec, size_t first, size_t count);
+
     /**
      * @brief Ensure the vector has at least the given capacity.
      *
@@ -157,13 +761,16 @@ extern "C" {
      * @param vec      Vector to reserve storage for.
      * @param capacity Desired minimum capacity.
      *
-     * @return true if reallocation occurred, false otherwise.
+     * @return true if reallocation occurred, false otherwise
+     *         (including when capacity * elem_size would overflow).
      */
     extern bool vector_reserve(Vector *vec, size_t capacity);
 
     /**
      * @brief Shrink capacity to fit the current number of elements.
      *
+     * Capacity never drops below one element.
+     *
      * @param vec Vector to shrink.
      *
      * @return true if reallocation occurred, false otherwise.
@@ -182,6 +789,9 @@ extern "C" {
     /**
      * @brief Get the current storage capacity.
      *
+     * Counted from the first element: free slots left in front of it
+     * by the front operations are not included.
+     *
      * @param vec Vector to query.
      *
      * @return Capacity in elements.
@@ -210,6 +820,19 @@ extern "C" {
      */
     extern bool vector_insert(Vector *vec, size_t at, const void *src);
 
+    /**
+     * @brief Open an uninitialized slot at a given index.
+     *
+     * Elements at and after the index are shifted right. The slot
+     * must be constructed in place by the caller.
+     *
+     * @param vec Vector to modify.
+     * @param at  Insertion index (0 <= at <= size).
+     *
+     * @return Pointer to the new slot, or NULL on allocation failure.
+     */
+    extern void *vector_emplace_at(Vector *vec, size_t at);
+
     /**
      * @brief Erase an element at a given index.
      *
@@ -223,6 +846,98 @@ extern "C" {
      */
     extern bool vector_erase(Vector *vec, size_t at);
 
+    /**
+     * @brief Append a contiguous run of elements to the end of the vector.
+     *
+     * Storage is grown at most once and all elements are copied
+     * with a single memcpy.
+     *
+     * @param vec   Vector to append to.
+     * @param src   Pointer to count elements to copy into the vector.
+     *              May be NULL if count is zero.
+     * @param count Number of elements to append.
+     *
+     * @return Pointer to the first appended element,
+     *         or NULL on allocation failure.
+     */
+    extern void *vector_append_n(Vector *vec, const void *src, size_t count);
+
+    /**
+     * @brief Insert a contiguous run of elements at a given index.
+     *
+     * Elements at and after the index are shifted right by count
+     * with a single memmove.
+     *
+     * @param vec   Vector to modify.
+     * @param at    Insertion index (0 <= at <= size).
+     * @param src   Pointer to count elements to insert.
+     *              May be NULL if count is zero.
+     * @param count Number of elements to insert.
+     *
+     * @return true on success, false on allocation failure.
+     */
+    extern bool vector_insert_range(Vector *vec, size_t at, const void *src, size_t count);
+
+    /**
+     * @brief Erase a contiguous run of elements.
+     *
+     * Calls the destructor on each erased element (if provided).
+     * Remaining elements are shifted left with a single memmove.
+     *
+     * @param vec   Vector to modify.
+     * @param first Index of the first element to erase.
+     * @param count Number of elements to erase (first + count <= size).
+     *
+     * @return true on success.
+     */
+    extern bool vector_erase_range(Vector *vec, size_t first, size_t count);
+
+    /**
+     * @brief Erase an element by moving the last element into its place.
+     *
+     * Calls the destructor on the erased element (if provided).
+     * O(1), but does not preserve the order of elements.
+     *
+     * @param vec Vector to modify.
+     * @param at  Index of element to erase.
+     *
+     * @return true on success.
+     */
+    extern bool vector_swap_remove(Vector *vec, size_t at);
+
+    /**
+     * @brief Erase every element matching a predicate, preserving order.
+     *
+     * Single linear pass: each kept element is moved at most once.
+     * Calls the destructor on each erased element (if provided).
+     *
+     * @param vec  Vector to modify.
+     * @param pred Returns true for elements to erase.
+     * @param ctx  User context passed to pred.
+     *
+     * @return Number of erased elements.
+     */
+    extern size_t vector_remove_if(Vector *vec,
+                                   bool (*pred)(const void *elem, void *ctx),
+                                   void *ctx);
+
+    /**
+     * @brief Erase every element matching a predicate, without preserving order.
+     *
+     * Holes are filled with kept elements taken from the end, which
+     * minimizes the number of element moves.
+     * Calls the destructor on each erased element (if provided).
+     *
+     * @param vec  Vector to modify.
+     * @param pred Returns true for elements to erase.
+     * @param ctx  User context passed to pred.
+     *
+     * @return Number of erased elements.
+     */
+    extern size_t vector_remove_if_unordered(Vector *vec,
+                                             bool (*pred)(const void *elem, void *ctx),
+                                             void *ctx);
+
     /**
      * @brief Get a pointer to the first element.
      *
@@ -262,6 +977,507 @@ extern "C" {
      */
     extern Vector *vector_clone(const Vector *vec);
 
+    /**
+     * @brief Create an empty vector configured like another one.
+     *
+     * The result has vec's element size, destructors, allocator,
+     * alignment and growth policy, but no elements, and heap storage
+     * for exactly capacity elements.
+     *
+     * @param vec      Vector to take the configuration from.
+     * @param capacity Number of elements to allocate room for (0 is treated as 1).
+     *
+     * @return New empty vector, or NULL on failure.
+     */
+    extern Vector *vector_clone_empty(const Vector *vec, size_t capacity);
+
+    /**
+     * @brief Create a deep clone of a vector.
+     *
+     * Storage is allocated once at the exact size and each element is
+     * constructed in place by copy, which should duplicate whatever
+     * the element owns so that both vectors can run the destructor.
+     * If copy fails, the elements copied so far are destroyed.
+     *
+     * @param vec  Vector to clone.
+     * @param copy Construct *dst as a copy of *src; return false on failure.
+     * @param ctx  User context passed to copy.
+     *
+     * @return New vector with copied contents, or NULL on failure.
+     */
+    extern Vector *vector_clone_deep(const Vector *vec,
+                                     bool (*copy)(void *dst, const void *src, void *ctx),
+                                     void *ctx);
+
+    /**
+     * @brief Create a deep clone of a vector with a batch copy callback.
+     *
+     * Like vector_clone_deep, but copy_range is called once for the
+     * whole contents. On failure it must leave no constructed
+     * elements behind in dst.
+     *
+     * @param vec        Vector to clone.
+     * @param copy_range Construct count elements at dst from src; return false on failure.
+     * @param ctx        User context passed to copy_range.
+     *
+     * @return New vector with copied contents, or NULL on failure.
+     */
+    extern Vector *vector_clone_deep_range(const Vector *vec,
+                                           bool (*copy_range)(void *dst, const void *src, size_t count, void *ctx),
+                                           void *ctx);
+
+    /**
+     * @brief Create a copy-on-write clone of a vector.
+     *
+     * The clone shares the source's storage through a reference count
+     * instead of copying it. Whichever vector is first modified
+     * (push, insert, erase, sort, reserve, vector_at_mut, ...) takes a
+     * private copy at that point; read-only use never copies.
+     *
+     * Pointers from vector_at, vector_data and the other read
+     * accessors point into the shared storage and must not be written
+     * through: use vector_at_mut or vector_data_mut instead. Clones of
+     * the same storage may be used and destroyed on different threads.
+     *
+     * Elements are shared and privately copied bitwise, so only
+     * plain data can be shared: vectors with a destructor or range
+     * destructor are copied eagerly, as with vector_clone, and so are
+     * inline, reserved and mapped vectors.
+     *
+     * @param vec Vector to clone. Its storage becomes shared as well.
+     *
+     * @return New vector sharing vec's contents, or NULL on failure.
+     */
+    extern Vector *vector_clone_cow(Vector *vec);
+
+    /**
+     * @brief Get a writable pointer to the element at index.
+     *
+     * Copies shared copy-on-write storage first if needed.
+     *
+     * @param vec Vector to access.
+     * @param idx Index of the element.
+     *
+     * @return Pointer to element, or NULL if a private copy could not be
+     *         allocated or the vector maps a file read-only.
+     */
+    extern void *vector_at_mut(Vector *vec, size_t idx);
+
+    /**
+     * @brief Get a writable pointer to the underlying storage.
+     *
+     * Copies shared copy-on-write storage first if needed.
+     *
+     * @param vec Vector to access.
+     *
+     * @return Pointer to storage, or NULL if a private copy could not be
+     *         allocated or the vector maps a file read-only.
+     */
+    extern void *vector_data_mut(Vector *vec);
+
+    /*
+     * Checked variants. Unlike the functions above, which assert on
+     * bad indices (a no-op with NDEBUG), these test every argument
+     * in all builds and report why they failed. On any result other
+     * than VECTOR_OK the vector is left unchanged.
+     */
+
+    /**
+     * @brief Ensure the vector has at least the given capacity.
+     *
+     * @param vec      Vector to reserve storage for.
+     * @param capacity Desired minimum capacity. Smaller values are a no-op.
+     *
+     * @return VECTOR_OK (also when no reallocation was needed),
+     *         VECTOR_OVERFLOW, VECTOR_UNSUPPORTED or VECTOR_OOM.
+     */
+    extern VectorResult vector_try_reserve(Vector *vec, size_t capacity);
+
+    /**
+     * @brief Append an element by copying it.
+     *
+     * @param vec  Vector to append to.
+     * @param elem Pointer to the element to copy.
+     *
+     * @return VECTOR_OK, VECTOR_OVERFLOW, VECTOR_UNSUPPORTED or VECTOR_OOM.
+     */
+    extern VectorResult vector_try_push_back(Vector *vec, const void *elem);
+
+    /**
+     * @brief Append count elements copied from a contiguous array.
+     *
+     * @param vec   Vector to append to.
+     * @param src   Elements to copy. May be NULL if count is 0.
+     * @param count Number of elements.
+     *
+     * @return VECTOR_OK, VECTOR_OVERFLOW, VECTOR_UNSUPPORTED or VECTOR_OOM.
+     */
+    extern VectorResult vector_try_append_n(Vector *vec, const void *src, size_t count);
+
+    /**
+     * @brief Insert an element before the given index.
+     *
+     * @param vec Vector to insert into.
+     * @param at  Insertion index (0 <= at <= size).
+     * @param src Pointer to the element to copy.
+     *
+     * @return VECTOR_OK, VECTOR_OUT_OF_RANGE, VECTOR_OVERFLOW,
+     *         VECTOR_UNSUPPORTED or VECTOR_OOM.
+     */
+    extern VectorResult vector_try_insert(Vector *vec, size_t at, const void *src);
+
+    /**
+     * @brief Erase the element at the given index.
+     *
+     * @param vec Vector to erase from.
+     * @param at  Index of the element (0 <= at < size).
+     *
+     * @return VECTOR_OK, VECTOR_OUT_OF_RANGE, VECTOR_UNSUPPORTED for a
+     *         mapped vector, or VECTOR_OOM if shared copy-on-write
+     *         storage could not be copied first.
+     */
+    extern VectorResult vector_try_erase(Vector *vec, size_t at);
+
+    /**
+     * @brief Remove the last element and copy it out.
+     *
+     * @param vec Vector to pop from.
+     * @param out Destination of elem_size bytes.
+     *
+     * @return VECTOR_OK, or VECTOR_OUT_OF_RANGE if the vector is empty.
+     */
+    extern VectorResult vector_try_pop_back(Vector *vec, void *out);
+
+    /**
+     * @brief Access an element by index.
+     *
+     * @param vec Vector to access.
+     * @param idx Index of the element.
+     * @param out Receives a pointer to the element.
+     *
+     * @return VECTOR_OK, or VECTOR_OUT_OF_RANGE if idx >= size.
+     */
+    extern VectorResult vector_try_at(const Vector *vec, size_t idx, void **out);
+
+    /**
+     * @brief Write a vector's elements to a binary file.
+     *
+     * The file holds a 56-byte header (magic, format version, byte
+     * order, elem_size, count, alignment, data offset and a 64-bit
+     * checksum of the data) followed by padding and the raw elements,
+     * starting at an offset aligned to max(64, alignment). Elements
+     * are written bitwise, so they must not contain pointers.
+     *
+     * @param vec  Vector to write.
+     * @param file Stream opened in binary mode, positioned at the start
+     *             of the data to write.
+     *
+     * @return true on success, false on a write error.
+     */
+    extern bool vector_write(const Vector *vec, FILE *file);
+
+    /**
+     * @brief Read a vector written by vector_write into a new heap vector.
+     *
+     * The data is read with a single bulk fread and its checksum is
+     * verified.
+     *
+     * @param file       Stream positioned at a vector_write header.
+     * @param destructor Optional per-element destructor. May be NULL.
+     *
+     * @return New vector, or NULL on I/O error, malformed or corrupt
+     *         data, or allocation failure.
+     */
+    extern Vector *vector_read(FILE *file, void (*destructor)(void *));
+
+    /**
+     * @brief Map a file written by vector_write as a read-only vector.
+     *
+     * The returned vector's storage points straight into a read-only,
+     * shared mapping of the file: nothing is copied, pages are loaded
+     * on first access, and processes mapping the same file share the
+     * page cache. Functions that would write to the storage (push,
+     * insert, erase, sort, fill, vector_at_mut, ...) fail instead,
+     * returning false, NULL or 0 or doing nothing; popping and
+     * clearing only drop elements from the view. vector_clone gives
+     * a mutable copy.
+     *
+     * Where virtual memory APIs are unavailable the file is read into
+     * a heap vector instead.
+     *
+     * @param path   Path of the file.
+     * @param verify Whether to check the data checksum, which reads the
+     *               whole file up front.
+     *
+     * @return New vector, or NULL if the file cannot be opened or mapped,
+     *         is malformed, or fails verification.
+     */
+    extern Vector *vector_map_file(const char *path, bool verify);
+
+    /**
+     * @brief Sort the elements of a vector.
+     *
+     * Keyed orders use a stable LSD radix sort, which needs a scratch
+     * buffer of size * elem_size bytes from the vector's allocator.
+     * Comparator orders use qsort.
+     *
+     * @param vec   Vector to sort.
+     * @param order Ordering to apply.
+     *
+     * @return true on success, false if the scratch buffer could not
+     *         be allocated (the vector is left unchanged).
+     */
+    extern bool vector_sort(Vector *vec, const VectorOrder *order);
+
+    /**
+     * @brief Find the first element not ordered before a probe.
+     *
+     * The vector must be sorted by order.
+     *
+     * @param vec   Vector to search.
+     * @param probe Key to look for (see VectorOrder).
+     * @param order Ordering of the vector.
+     *
+     * @return Index of the first element >= probe, or size if none.
+     */
+    extern size_t vector_lower_bound(const Vector *vec, const void *probe, const VectorOrder *order);
+
+    /**
+     * @brief Test whether a sorted vector contains a key.
+     *
+     * @param vec     Vector to search, sorted by order.
+     * @param probe   Key to look for (see VectorOrder).
+     * @param order   Ordering of the vector.
+     * @param out_idx If non-NULL, receives vector_lower_bound's result.
+     *
+     * @return true if an element equal to probe was found.
+     */
+    extern bool vector_binary_search(const Vector *vec,
+                                     const void *probe,
+                                     const VectorOrder *order,
+                                     size_t *out_idx);
+
+    /**
+     * @brief Insert an element into a sorted vector, keeping it sorted.
+     *
+     * The element goes after any equal elements. With a comparator
+     * order, elem is passed as the first argument of cmp.
+     *
+     * @param vec   Vector sorted by order.
+     * @param elem  Pointer to element data to insert.
+     * @param order Ordering of the vector.
+     *
+     * @return Pointer to the inserted element, or NULL on allocation failure.
+     */
+    extern void *vector_insert_sorted(Vector *vec, const void *elem, const VectorOrder *order);
+
+    /**
+     * @brief Find the first element bitwise equal to elem.
+     *
+     * Element sizes of 1, 2, 4 and 8 bytes use SIMD kernels
+     * (SSE2/AVX2 selected at runtime on x86, NEON on AArch64); other
+     * sizes compare with memcmp. Floating-point values are compared
+     * by representation, not numerically.
+     *
+     * @param vec  Vector to search.
+     * @param elem Pointer to the element to look for.
+     *
+     * @return Index of the first match, or size if there is none.
+     */
+    extern size_t vector_find(const Vector *vec, const void *elem);
+
+    /**
+     * @brief Test whether any element is bitwise equal to elem.
+     *
+     * @param vec  Vector to search.
+     * @param elem Pointer to the element to look for.
+     *
+     * @return true if found, false otherwise.
+     */
+    extern bool vector_contains(const Vector *vec, const void *elem);
+
+    /**
+     * @brief Count the elements bitwise equal to elem.
+     *
+     * Uses the same kernels as vector_find.
+     *
+     * @param vec  Vector to search.
+     * @param elem Pointer to the element to count.
+     *
+     * @return Number of matching elements.
+     */
+    extern size_t vector_count(const Vector *vec, const void *elem);
+
+    /**
+     * @brief Overwrite a range of elements with copies of elem.
+     *
+     * Elements are bitwise-copied; overwritten elements are NOT
+     * destroyed. Does nothing if shared copy-on-write storage cannot
+     * be copied.
+     *
+     * @param vec   Vector to modify.
+     * @param first Index of the first element to overwrite.
+     * @param count Number of elements to overwrite (first + count <= size).
+     * @param elem  Pointer to the value to copy.
+     */
+    extern void vector_fill(Vector *vec, size_t first, size_t count, const void *elem);
+
+    /**
+     * @brief Test whether two vectors hold bitwise-identical elements.
+     *
+     * @param a First vector.
+     * @param b Second vector.
+     *
+     * @return true if both have the same element size, size and bytes.
+     */
+    extern bool vector_equal(const Vector *a, const Vector *b);
+
+#ifdef VECTOR_STATS
+    /**
+     * @brief Read the instrumentation counters of a vector.
+     *
+     * @param vec Vector to query.
+     * @param out Receives the counters.
+     */
+    extern void vector_get_stats(const Vector *vec, VectorStats *out);
+
+    /**
+     * @brief Attach a label (e.g. the creating call site) to a vector.
+     *
+     * @param vec   Vector to label.
+     * @param label Static string, not copied. May be NULL.
+     */
+    extern void vector_stats_set_label(Vector *vec, const char *label);
+
+    /**
+     * @brief Visit every live vector in the global registry.
+     *
+     * The registry is locked for the duration of the walk: fn must
+     * not create or destroy vectors.
+     *
+     * @param fn  Callback receiving each vector and its counters.
+     * @param ctx User context passed to fn.
+     */
+    extern void vector_stats_foreach(void (*fn)(const Vector *vec, const VectorStats *stats, void *ctx),
+                                     void *ctx);
+
+    /**
+     * @brief Install a callback fired on every storage growth.
+     *
+     * The hook runs on the thread performing the growth.
+     *
+     * @param hook Callback, or NULL to remove it.
+     * @param ctx  User context passed to hook.
+     */
+    extern void vector_stats_set_growth_hook(VectorGrowthHook hook, void *ctx);
+#endif /* VECTOR_STATS */
+
+#if defined(VECTOR_EXPOSE_LAYOUT) && !defined(VECTOR_BUILD)
+    /**
+     * @brief Define a vector type specialized for element type T.
+     *
+     * Generates `typedef struct name { Vector vec; } name;` and static
+     * inline functions prefixed with `name_` whose element size is
+     * sizeof(T) at compile time, so element copies compile down to
+     * plain loads and stores. Growth, destructors and all other
+     * semantics are those of the generic Vector; `name_base` returns
+     * the underlying Vector for use with the rest of the API.
+     *
+     * Requires VECTOR_EXPOSE_LAYOUT.
+     *
+     * @param name Name of the generated type and function prefix.
+     * @param T    Element type.
+     *
+     * Example:
+     * @code
+     * VECTOR_DEFINE(IntVector, int)
+     *
+     * IntVector ints;
+     * IntVector_init(&ints, 0, NULL);
+     * IntVector_push_back(&ints, 42);
+     * printf("%d\n", IntVector_get(&ints, 0));
+     * IntVector_deinit(&ints);
+     * @endcode
+     */
+#define VECTOR_DEFINE(name, T)                                                  \
+    typedef struct name {                                                       \
+        Vector vec;                                                             \
+    } name;                                                                     \
+                                                                                \
+    static inline bool name##_init(name *v, size_t capacity,                    \
+                                   void (*destructor)(void *)) {                \
+        return vector_init(&v->vec, capacity, sizeof(T), destructor);           \
+    }                                                                           \
+                                                                                \
+    static inline void name##_deinit(name *v) {                                 \
+        vector_deinit(&v->vec);                                                 \
+    }                                                                           \
+                                                                                \
+    static inline Vector *name##_base(name *v) {                                \
+        return &v->vec;                                                         \
+    }                                                                           \
+                                                                                \
+    static inline size_t name##_size(const name *v) {                          \
+        return v->vec.elem_count;                                               \
+    }                                                                           \
+                                                                                \
+    static inline size_t name##_capacity(const name *v) {                      \
+        return v->vec.capacity;                                                 \
+    }                                                                           \
+                                                                                \
+    static inline T *name##_data(const name *v) {                               \
+        return (T *)v->vec.value;                                               \
+    }                                                                           \
+                                                                                \
+    static inline T *name##_begin(const name *v) {                              \
+        return (T *)v->vec.value;                                               \
+    }                                                                           \
+                                                                                \
+    static inline T *name##_end(const name *v) {                                \
+        return (T *)v->vec.value + v->vec.elem_count;                           \
+    }                                                                           \
+                                                                                \
+    static inline T *name##_at(const name *v, size_t idx) {                     \
+        assert(idx < v->vec.elem_count);                                        \
+        return (T *)v->vec.value + idx;                                         \
+    }                                                                           \
+                                                                                \
+    static inline T name##_get(const name *v, size_t idx) {                     \
+        assert(idx < v->vec.elem_count);                                        \
+        return ((const T *)v->vec.value)[idx];                                  \
+    }                                                                           \
+                                                                                \
+    static inline T *name##_push_back(name *v, T elem) {                        \
+        if (v->vec.elem_count < v->vec.capacity && !v->vec.shared) {            \
+            T *slot = (T *)v->vec.value + v->vec.elem_count++;                  \
+            *slot = elem;                                                       \
+            return slot;                                                        \
+        }                                                                       \
+        return (T *)vector_push_back(&v->vec, &elem);                           \
+    }                                                                           \
+                                                                                \
+    static inline T name##_pop_back(name *v) {                                  \
+        assert(v->vec.elem_count > 0);                                          \
+        return ((T *)v->vec.value)[--v->vec.elem_count];                        \
+    }                                                                           \
+                                                                                \
+    static inline bool name##_insert(name *v, size_t at, T elem) {              \
+        return vector_insert(&v->vec, at, &elem);                               \
+    }                                                                           \
+                                                                                \
+    static inline bool name##_erase(name *v, size_t at) {                       \
+        return vector_erase(&v->vec, at);                                       \
+    }                                                                           \
+                                                                                \
+    static inline bool name##_reserve(name *v, size_t capacity) {               \
+        return vector_reserve(&v->vec, capacity);                               \
+    }                                                                           \
+                                                                                \
+    static inline void name##_clear(name *v) {                                  \
+        vector_clear(&v->vec);                                                  \
+    }
+#endif /* VECTOR_EXPOSE_LAYOUT && !VECTOR_BUILD */
+
 /* Ends C function definitions when using C++ */
 #ifdef __cplusplus
 }
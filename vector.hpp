@@ -0,0 +1,333 @@
+/**
+ * @file vector.hpp
+ * @author itsjustgalileo
+ * @version 1.2
+ * @brief C++ RAII wrapper over the C Vector API.
+ */
+#ifndef VECTOR_HPP_
+#define VECTOR_HPP_
+
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus >= 202002L
+#include <span>
+#endif /* C++20 */
+
+#include "vector.h"
+
+namespace cvec {
+
+    /**
+     * @brief Whether T may be moved in memory with a bitwise copy.
+     *
+     * Vector storage is grown with realloc/memcpy, so elements are
+     * relocated bitwise. This holds for trivially copyable types;
+     * specialize the trait for other types known to be safe.
+     */
+    template <typename T>
+    struct is_relocatable : std::is_trivially_copyable<T> {};
+
+    /**
+     * @brief Owning, move-only-by-default handle to a C Vector of T.
+     *
+     * Move construction and assignment steal the underlying Vector
+     * pointer: no allocation and no element copy. Iterators are plain
+     * pointers into contiguous storage, so <algorithm> and the
+     * parallel algorithms apply directly.
+     *
+     * Operations that fail to allocate throw std::bad_alloc. Non-const
+     * element access goes through vector_data_mut, so an adopted
+     * copy-on-write clone is copied before it is written through; it
+     * also throws std::bad_alloc for an adopted read-only mapping.
+     */
+    template <typename T>
+    class vector {
+        static_assert(is_relocatable<T>::value,
+                      "cvec::vector requires a bitwise-relocatable element type");
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = T &;
+        using const_reference = const T &;
+        using pointer = T *;
+        using const_pointer = const T *;
+        using iterator = T *;
+        using const_iterator = const T *;
+
+        /**
+         * @brief Create an empty vector.
+         *
+         * @param capacity Initial number of elements to reserve.
+         */
+        explicit vector(size_type capacity = 0)
+            : vec_(vector_create(capacity, sizeof(T), destructor())) {
+            if (nullptr == vec_) {
+                throw std::bad_alloc();
+            }
+        }
+
+        /**
+         * @brief Take ownership of an existing C vector of T.
+         *
+         * @param vec Vector created with elem_size == sizeof(T).
+         */
+        static vector adopt(::Vector *vec) noexcept {
+            return vector(vec, adopt_tag());
+        }
+
+        vector(const vector &other) : vector(other.size()) {
+            if (std::is_trivially_copyable<T>::value) {
+                if (other.size() != 0 && !vector_append_n(vec_, other.data(), other.size())) {
+                    throw std::bad_alloc();
+                }
+            } else {
+                for (const T &elem : other) {
+                    push_back(elem);
+                }
+            }
+        }
+
+        vector(vector &&other) noexcept : vec_(other.vec_) {
+            other.vec_ = nullptr;
+        }
+
+        vector &operator=(const vector &other) {
+            if (this != &other) {
+                vector tmp(other);
+                swap(tmp);
+            }
+
+            return *this;
+        }
+
+        vector &operator=(vector &&other) noexcept {
+            if (this != &other) {
+                reset();
+                vec_ = other.vec_;
+                other.vec_ = nullptr;
+            }
+
+            return *this;
+        }
+
+        ~vector() {
+            reset();
+        }
+
+        void swap(vector &other) noexcept {
+            std::swap(vec_, other.vec_);
+        }
+
+        /**
+         * @brief Get the underlying C vector (still owned by this object).
+         */
+        ::Vector *get() const noexcept {
+            return vec_;
+        }
+
+        /**
+         * @brief Give up ownership of the underlying C vector.
+         */
+        ::Vector *release() noexcept {
+            ::Vector *vec = vec_;
+            vec_ = nullptr;
+
+            return vec;
+        }
+
+        size_type size() const noexcept {
+            return vec_ ? vector_size(vec_) : 0;
+        }
+
+        size_type capacity() const noexcept {
+            return vec_ ? vector_capacity(vec_) : 0;
+        }
+
+        bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        T *data() {
+            if (nullptr == vec_) {
+                return nullptr;
+            }
+
+            void *ptr = vector_data_mut(vec_);
+            if (nullptr == ptr) {
+                throw std::bad_alloc();
+            }
+
+            return static_cast<T *>(ptr);
+        }
+
+        const T *data() const noexcept {
+            return vec_ ? static_cast<const T *>(vector_data(vec_)) : nullptr;
+        }
+
+        iterator begin() { return data(); }
+        iterator end() { return data() + size(); }
+        const_iterator begin() const noexcept { return data(); }
+        const_iterator end() const noexcept { return data() + size(); }
+        const_iterator cbegin() const noexcept { return data(); }
+        const_iterator cend() const noexcept { return data() + size(); }
+
+        T &operator[](size_type idx) { return data()[idx]; }
+        const T &operator[](size_type idx) const noexcept { return data()[idx]; }
+
+        T &at(size_type idx) {
+            if (idx >= size()) {
+                throw std::out_of_range("cvec::vector::at");
+            }
+
+            return data()[idx];
+        }
+
+        const T &at(size_type idx) const {
+            if (idx >= size()) {
+                throw std::out_of_range("cvec::vector::at");
+            }
+
+            return data()[idx];
+        }
+
+        T &front() { return data()[0]; }
+        const T &front() const noexcept { return data()[0]; }
+        T &back() { return data()[size() - 1]; }
+        const T &back() const noexcept { return data()[size() - 1]; }
+
+        void reserve(size_type capacity) {
+            ensure();
+            vector_reserve(vec_, capacity);
+            if (vector_capacity(vec_) < capacity) {
+                throw std::bad_alloc();
+            }
+        }
+
+        void shrink_to_fit() {
+            if (vec_) {
+                vector_shrink_to_fit(vec_);
+            }
+        }
+
+        void clear() noexcept {
+            if (vec_) {
+                vector_clear(vec_);
+            }
+        }
+
+        void push_back(const T &elem) {
+            emplace_back(elem);
+        }
+
+        void push_back(T &&elem) {
+            emplace_back(std::move(elem));
+        }
+
+        /**
+         * @brief Construct an element in place at the end of the vector.
+         *
+         * The element is built directly in the slot returned by
+         * vector_emplace_back, with no intermediate copy.
+         */
+        template <typename... Args>
+        T &emplace_back(Args &&...args) {
+            ensure();
+
+            void *slot = vector_emplace_back(vec_);
+            if (nullptr == slot) {
+                throw std::bad_alloc();
+            }
+
+            try {
+                return *::new (slot) T(std::forward<Args>(args)...);
+            } catch (...) {
+                /* Drop the unconstructed slot without running the destructor. */
+                vector_take_back(vec_);
+                throw;
+            }
+        }
+
+        void pop_back() {
+            if (!vector_pop_back_n(vec_, 1, nullptr)) {
+                throw std::bad_alloc();
+            }
+        }
+
+        iterator erase(const_iterator pos) {
+            const size_type idx = static_cast<size_type>(pos - cbegin());
+            vector_erase(vec_, idx);
+
+            return begin() + idx;
+        }
+
+        iterator erase(const_iterator first, const_iterator last) {
+            const size_type idx = static_cast<size_type>(first - cbegin());
+            vector_erase_range(vec_, idx, static_cast<size_type>(last - first));
+
+            return begin() + idx;
+        }
+
+#if __cplusplus >= 202002L
+        std::span<T> span() {
+            return std::span<T>(data(), size());
+        }
+
+        std::span<const T> span() const noexcept {
+            return std::span<const T>(data(), size());
+        }
+
+        operator std::span<T>() {
+            return span();
+        }
+
+        operator std::span<const T>() const noexcept {
+            return span();
+        }
+#endif /* C++20 */
+
+    private:
+        struct adopt_tag {};
+
+        vector(::Vector *vec, adopt_tag) noexcept : vec_(vec) {}
+
+        static void destroy_element(void *elem) {
+            static_cast<T *>(elem)->~T();
+        }
+
+        static constexpr void (*destructor())(void *) {
+            return std::is_trivially_destructible<T>::value ? nullptr : &destroy_element;
+        }
+
+        void ensure() {
+            if (nullptr == vec_) {
+                vec_ = vector_create(0, sizeof(T), destructor());
+                if (nullptr == vec_) {
+                    throw std::bad_alloc();
+                }
+            }
+        }
+
+        void reset() noexcept {
+            if (vec_) {
+                vector_destroy(vec_);
+                vec_ = nullptr;
+            }
+        }
+
+        ::Vector *vec_;
+    };
+
+    template <typename T>
+    void swap(vector<T> &lhs, vector<T> &rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+} /* namespace cvec */
+
+#endif /* VECTOR_HPP_ */
@@ -0,0 +1,264 @@
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define VECTOR_BUILD
+#include "vector_channel.h"
+#include "vector_internal.h"
+
+/*
+ * MPMC slots carry a sequence number (bounded queue after Vyukov):
+ * a slot at position pos is free to write when its sequence equals
+ * pos and ready to read when it equals pos + 1. SPSC channels use
+ * only the two positions, each side caching the other's.
+ */
+typedef struct VectorChannelSlot {
+    size_t sequence;                    /**< Position the slot is ready for (MPMC only). */
+    Vector *value;                      /**< Queued vector. */
+} VectorChannelSlot;
+
+struct VectorChannel {
+    size_t tail;                        /**< Next position to write. */
+    size_t cached_head;                 /**< Producer's last view of head (SPSC only). */
+    char pad0[VECTOR_CACHE_LINE - 2 * sizeof(size_t)]; /**< Keeps producer and consumer state apart. */
+    size_t head;                        /**< Next position to read. */
+    size_t cached_tail;                 /**< Consumer's last view of tail (SPSC only). */
+    char pad1[VECTOR_CACHE_LINE - 2 * sizeof(size_t)]; /**< Keeps consumer state off the shared fields. */
+    VectorChannelSlot *slots;           /**< Ring of capacity slots. */
+    size_t mask;                        /**< capacity - 1. */
+    VectorChannelMode mode;             /**< Which threads may send and receive. */
+};
+
+struct VectorPool {
+    VectorChannel *idle;                /**< Cleared vectors ready for reuse. */
+    size_t elem_size;                   /**< Element size of pooled vectors. */
+    size_t capacity;                    /**< Initial capacity of new vectors. */
+    void (*destructor)(void *);         /**< Destructor of pooled vectors. */
+    const VectorAllocator *allocator;   /**< Allocator of pooled vectors, or NULL. */
+};
+
+VectorChannel *vector_channel_create(const size_t capacity, const VectorChannelMode mode) {
+    size_t slots = 2;
+    while (slots < capacity) {
+        if (slots > SIZE_MAX / 2 / sizeof(VectorChannelSlot)) {
+            return NULL;
+        }
+
+        slots <<= 1;
+    }
+
+    VectorChannel *channel = (VectorChannel *)malloc(sizeof(VectorChannel));
+    if (NULL == channel) {
+        return NULL;
+    }
+
+    memset(channel, 0, sizeof(*channel));
+    channel->slots = (VectorChannelSlot *)malloc(slots * sizeof(VectorChannelSlot));
+    if (NULL == channel->slots) {
+        free(channel);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < slots; ++i) {
+        channel->slots[i].sequence = i;
+        channel->slots[i].value = NULL;
+    }
+
+    channel->mask = slots - 1;
+    channel->mode = mode;
+
+    return channel;
+}
+
+void vector_channel_destroy(VectorChannel *channel) {
+    assert(channel);
+
+    Vector *vec = NULL;
+    while ((vec = vector_channel_recv(channel))) {
+        vector_destroy(vec);
+    }
+
+    free(channel->slots);
+    free(channel);
+
+    return;
+}
+
+static bool vector_channel_send_spsc(VectorChannel *channel, Vector *vec) {
+    const size_t tail = channel->tail;
+
+    if (tail - channel->cached_head > channel->mask) {
+        channel->cached_head = vector_atomic_load(&channel->head, VECTOR_ACQUIRE);
+        if (tail - channel->cached_head > channel->mask) {
+            return false;
+        }
+    }
+
+    channel->slots[tail & channel->mask].value = vec;
+    vector_atomic_store(&channel->tail, tail + 1, VECTOR_RELEASE);
+
+    return true;
+}
+
+static Vector *vector_channel_recv_spsc(VectorChannel *channel) {
+    const size_t head = channel->head;
+
+    if (head == channel->cached_tail) {
+        channel->cached_tail = vector_atomic_load(&channel->tail, VECTOR_ACQUIRE);
+        if (head == channel->cached_tail) {
+            return NULL;
+        }
+    }
+
+    Vector *vec = channel->slots[head & channel->mask].value;
+    vector_atomic_store(&channel->head, head + 1, VECTOR_RELEASE);
+
+    return vec;
+}
+
+static bool vector_channel_send_mpmc(VectorChannel *channel, Vector *vec) {
+    size_t pos = vector_atomic_load(&channel->tail, VECTOR_RELAXED);
+    VectorChannelSlot *slot = NULL;
+
+    for (;;) {
+        slot = &channel->slots[pos & channel->mask];
+
+        const size_t sequence = vector_atomic_load(&slot->sequence, VECTOR_ACQUIRE);
+        const intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+
+        if (diff == 0) {
+            if (vector_atomic_cas(&channel->tail, &pos, pos + 1)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = vector_atomic_load(&channel->tail, VECTOR_RELAXED);
+        }
+    }
+
+    slot->value = vec;
+    vector_atomic_store(&slot->sequence, pos + 1, VECTOR_RELEASE);
+
+    return true;
+}
+
+static Vector *vector_channel_recv_mpmc(VectorChannel *channel) {
+    size_t pos = vector_atomic_load(&channel->head, VECTOR_RELAXED);
+    VectorChannelSlot *slot = NULL;
+
+    for (;;) {
+        slot = &channel->slots[pos & channel->mask];
+
+        const size_t sequence = vector_atomic_load(&slot->sequence, VECTOR_ACQUIRE);
+        const intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+
+        if (diff == 0) {
+            if (vector_atomic_cas(&channel->head, &pos, pos + 1)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return NULL;
+        } else {
+            pos = vector_atomic_load(&channel->head, VECTOR_RELAXED);
+        }
+    }
+
+    Vector *vec = slot->value;
+    vector_atomic_store(&slot->sequence, pos + channel->mask + 1, VECTOR_RELEASE);
+
+    return vec;
+}
+
+bool vector_channel_send(VectorChannel *channel, Vector *vec) {
+    assert(channel && vec);
+
+    if (channel->mode == VECTOR_CHANNEL_SPSC) {
+        return vector_channel_send_spsc(channel, vec);
+    }
+
+    return vector_channel_send_mpmc(channel, vec);
+}
+
+Vector *vector_channel_recv(VectorChannel *channel) {
+    assert(channel);
+
+    if (channel->mode == VECTOR_CHANNEL_SPSC) {
+        return vector_channel_recv_spsc(channel);
+    }
+
+    return vector_channel_recv_mpmc(channel);
+}
+
+size_t vector_channel_capacity(const VectorChannel *channel) {
+    assert(channel);
+
+    return channel->mask + 1;
+}
+
+VectorPool *vector_pool_create(const size_t elem_size,
+                               const size_t capacity,
+                               void (*destructor)(void *),
+                               const size_t max_cached) {
+    return vector_pool_create_with_allocator(elem_size, capacity, destructor, max_cached, NULL);
+}
+
+VectorPool *vector_pool_create_with_allocator(const size_t elem_size,
+                                              const size_t capacity,
+                                              void (*destructor)(void *),
+                                              const size_t max_cached,
+                                              const VectorAllocator *allocator) {
+    assert(elem_size > 0);
+
+    VectorPool *pool = (VectorPool *)malloc(sizeof(VectorPool));
+    if (NULL == pool) {
+        return NULL;
+    }
+
+    pool->idle = vector_channel_create(max_cached, VECTOR_CHANNEL_MPMC);
+    if (NULL == pool->idle) {
+        free(pool);
+        return NULL;
+    }
+
+    pool->elem_size = elem_size;
+    pool->capacity = capacity;
+    pool->destructor = destructor;
+    pool->allocator = allocator;
+
+    return pool;
+}
+
+void vector_pool_destroy(VectorPool *pool) {
+    assert(pool);
+
+    vector_channel_destroy(pool->idle);
+    free(pool);
+
+    return;
+}
+
+Vector *vector_pool_acquire(VectorPool *pool) {
+    assert(pool);
+
+    Vector *vec = vector_channel_recv(pool->idle);
+    if (vec) {
+        return vec;
+    }
+
+    return vector_create_with_allocator(pool->capacity, pool->elem_size, pool->destructor, pool->allocator);
+}
+
+void vector_pool_release(VectorPool *pool, Vector *vec) {
+    assert(pool && vec && vec->elem_size == pool->elem_size);
+
+    vector_clear(vec);
+
+    if (!vector_channel_send(pool->idle, vec)) {
+        vector_destroy(vec);
+    }
+
+    return;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file vector_channel.h
+ * @author itsjustgalileo
+ * @version 1.2
+ * @brief Lock-free handoff of Vector batches between threads, and a pool of reusable vectors.
+ */
+#ifndef VECTOR_CHANNEL_H_
+#define VECTOR_CHANNEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "vector.h"
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /**
+     * @brief Which threads may use a channel.
+     */
+    typedef enum VectorChannelMode {
+        /** One sending thread and one receiving thread. Cheapest: no compare-and-swap. */
+        VECTOR_CHANNEL_SPSC,
+        /** Any number of sending and receiving threads. */
+        VECTOR_CHANNEL_MPMC
+    } VectorChannelMode;
+
+    /**
+     * @brief Opaque bounded queue of Vector pointers.
+     *
+     * A fixed ring of slots; send and receive never lock or allocate
+     * and fail instead of waiting when the ring is full or empty.
+     * Ownership of a vector passes from the sender to the receiver.
+     */
+    typedef struct VectorChannel VectorChannel;
+
+    /**
+     * @brief Opaque pool of empty vectors with the same element type.
+     *
+     * Released vectors are cleared but keep their storage, and are
+     * handed out again by the next acquire, so a steady stream of
+     * batches stops allocating once the pool is warm. Acquire and
+     * release are lock-free and may be called from any thread.
+     */
+    typedef struct VectorPool VectorPool;
+
+    /**
+     * @brief Create a new channel.
+     *
+     * @param capacity Number of slots, rounded up to a power of two (at least 2).
+     * @param mode     Which threads may send and receive.
+     *
+     * @return Pointer to a new VectorChannel, or NULL on allocation failure.
+     */
+    extern VectorChannel *vector_channel_create(size_t capacity, VectorChannelMode mode);
+
+    /**
+     * @brief Destroy a channel.
+     *
+     * Vectors still queued are destroyed with vector_destroy.
+     * No other thread may use the channel concurrently.
+     *
+     * @param channel Channel to destroy.
+     */
+    extern void vector_channel_destroy(VectorChannel *channel);
+
+    /**
+     * @brief Queue a vector without blocking.
+     *
+     * @param channel Channel to send on.
+     * @param vec     Vector to hand off. Must not be NULL.
+     *
+     * @return true if queued (the receiver now owns vec),
+     *         false if the channel is full (the caller still owns vec).
+     */
+    extern bool vector_channel_send(VectorChannel *channel, Vector *vec);
+
+    /**
+     * @brief Dequeue a vector without blocking.
+     *
+     * @param channel Channel to receive from.
+     *
+     * @return The oldest queued vector, which the caller now owns,
+     *         or NULL if the channel is empty.
+     */
+    extern Vector *vector_channel_recv(VectorChannel *channel);
+
+    /**
+     * @brief Get the number of slots.
+     *
+     * @param channel Channel to query.
+     *
+     * @return Capacity of the channel.
+     */
+    extern size_t vector_channel_capacity(const VectorChannel *channel);
+
+    /**
+     * @brief Create a new vector pool.
+     *
+     * @param elem_size  Size of a single element in bytes.
+     * @param capacity   Initial capacity of vectors created by the pool.
+     * @param destructor Optional per-element destructor. May be NULL.
+     * @param max_cached Number of idle vectors kept for reuse, rounded up to a
+     *                   power of two (at least 2); more are destroyed.
+     *
+     * @return Pointer to a new VectorPool, or NULL on allocation failure.
+     */
+    extern VectorPool *vector_pool_create(size_t elem_size,
+                                          size_t capacity,
+                                          void (*destructor)(void *),
+                                          size_t max_cached);
+
+    /**
+     * @brief Create a new vector pool whose vectors use a custom allocator.
+     *
+     * @param elem_size  Size of a single element in bytes.
+     * @param capacity   Initial capacity of vectors created by the pool.
+     * @param destructor Optional per-element destructor. May be NULL.
+     * @param max_cached Number of idle vectors kept for reuse; more are destroyed.
+     * @param allocator  Allocator for new vectors, or NULL for malloc/free.
+     *                   Must be safe to call from every thread using the pool.
+     *
+     * @return Pointer to a new VectorPool, or NULL on allocation failure.
+     */
+    extern VectorPool *vector_pool_create_with_allocator(size_t elem_size,
+                                                         size_t capacity,
+                                                         void (*destructor)(void *),
+                                                         size_t max_cached,
+                                                         const VectorAllocator *allocator);
+
+    /**
+     * @brief Destroy a pool and the idle vectors it holds.
+     *
+     * Vectors currently acquired stay valid and may still be
+     * destroyed with vector_destroy, but not released to the pool.
+     *
+     * @param pool Pool to destroy.
+     */
+    extern void vector_pool_destroy(VectorPool *pool);
+
+    /**
+     * @brief Take an empty vector from the pool.
+     *
+     * Reuses an idle vector, with whatever capacity it had grown to,
+     * or creates a new one if none is idle.
+     *
+     * @param pool Pool to take from.
+     *
+     * @return Empty vector owned by the caller, or NULL on allocation failure.
+     */
+    extern Vector *vector_pool_acquire(VectorPool *pool);
+
+    /**
+     * @brief Return a vector to the pool.
+     *
+     * The vector is cleared (destructor called on each element, if
+     * provided), keeping its storage. It is destroyed instead if the
+     * pool already holds max_cached idle vectors.
+     *
+     * @param pool Pool the vector was acquired from.
+     * @param vec  Vector to return. Must not be used afterwards.
+     */
+    extern void vector_pool_release(VectorPool *pool, Vector *vec);
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VECTOR_CHANNEL_H_ */
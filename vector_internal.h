@@ -0,0 +1,182 @@
+/**
+ * @file vector_internal.h
+ * @author itsjustgalileo
+ * @version 1.2
+ * @brief Helpers shared by the library's translation units. Not part of the public API.
+ */
+#ifndef VECTOR_INTERNAL_H_
+#define VECTOR_INTERNAL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "vector.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif /* _MSC_VER */
+
+#define VECTOR_CACHE_LINE 64
+
+/* Storage class for per-thread state. */
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define VECTOR_THREAD_LOCAL _Thread_local
+#elif defined(_MSC_VER) && !defined(__clang__)
+#define VECTOR_THREAD_LOCAL __declspec(thread)
+#else
+#define VECTOR_THREAD_LOCAL __thread
+#endif /* __STDC_VERSION__ */
+
+/* malloc/realloc/free, used wherever the caller passes a NULL allocator. */
+extern const VectorAllocator vector_default_allocator;
+
+static inline const VectorAllocator *vector_allocator_or_default(const VectorAllocator *allocator) {
+    return NULL == allocator ? &vector_default_allocator : allocator;
+}
+
+static inline void *vector_mem_alloc(const VectorAllocator *allocator, const size_t size) {
+    return allocator->allocate(allocator->ctx, size);
+}
+
+static inline void vector_mem_free(const VectorAllocator *allocator, void *ptr, const size_t size) {
+    if (ptr && allocator->deallocate) {
+        allocator->deallocate(allocator->ctx, ptr, size);
+    }
+
+    return;
+}
+
+/* Index of the highest set bit. value must not be zero. */
+static inline unsigned vector_msb(const size_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)(sizeof(unsigned long long) * 8 - 1) - (unsigned)__builtin_clzll((unsigned long long)value);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long idx = 0;
+    _BitScanReverse64(&idx, (unsigned __int64)value);
+
+    return (unsigned)idx;
+#elif defined(_MSC_VER)
+    unsigned long idx = 0;
+    _BitScanReverse(&idx, (unsigned long)value);
+
+    return (unsigned)idx;
+#else
+    unsigned idx = 0;
+    size_t rest = value;
+    while (rest >>= 1) {
+        ++idx;
+    }
+
+    return idx;
+#endif
+}
+
+/*
+ * Doubling blocks, as used by the segmented and concurrent vectors:
+ * block k holds base << k elements and starts at index
+ * base * (2^k - 1), so index i lives in block
+ * msb(i + base) - log2(base). base is a power of two.
+ */
+static inline size_t vector_block_size(const size_t base, const unsigned block) {
+    return base << block;
+}
+
+static inline size_t vector_block_start(const size_t base, const unsigned block) {
+    return (base << block) - base;
+}
+
+/* Block holding index idx (idx + base must not overflow); *offset receives its slot in the block. */
+static inline unsigned vector_block_locate(const size_t base, const unsigned base_shift, const size_t idx, size_t *offset) {
+    const size_t pos = idx + base;
+    const unsigned block = vector_msb(pos) - base_shift;
+
+    *offset = pos - (base << block);
+
+    return block;
+}
+
+/*
+ * Atomics on size_t and pointers. GCC and Clang use the __atomic
+ * builtins with the memory order given; MSVC uses the Interlocked
+ * intrinsics (full barriers) and volatile accesses, which have
+ * acquire/release semantics under /volatile:ms.
+ */
+#if defined(_MSC_VER) && !defined(__clang__)
+#define VECTOR_RELAXED 0
+#define VECTOR_ACQUIRE 0
+#define VECTOR_RELEASE 0
+
+static inline size_t vector_atomic_load(const size_t *ptr, const int order) {
+    (void)order;
+
+    return *(const volatile size_t *)ptr;
+}
+
+static inline void vector_atomic_store(size_t *ptr, const size_t value, const int order) {
+    (void)order;
+
+    *(volatile size_t *)ptr = value;
+
+    return;
+}
+
+static inline size_t vector_atomic_fetch_add(size_t *ptr, const size_t value, const int order) {
+    (void)order;
+
+#ifdef _WIN64
+    return (size_t)_InterlockedExchangeAdd64((volatile __int64 *)ptr, (__int64)value);
+#else
+    return (size_t)_InterlockedExchangeAdd((volatile long *)ptr, (long)value);
+#endif /* _WIN64 */
+}
+
+/* Weak, relaxed compare-and-swap; on failure *expected receives the current value. */
+static inline bool vector_atomic_cas(size_t *ptr, size_t *expected, const size_t desired) {
+#ifdef _WIN64
+    const size_t seen = (size_t)_InterlockedCompareExchange64((volatile __int64 *)ptr, (__int64)desired, (__int64)*expected);
+#else
+    const size_t seen = (size_t)_InterlockedCompareExchange((volatile long *)ptr, (long)desired, (long)*expected);
+#endif /* _WIN64 */
+
+    if (seen == *expected) {
+        return true;
+    }
+
+    *expected = seen;
+
+    return false;
+}
+
+static inline void *vector_atomic_load_ptr(void *const *ptr) {
+    return *(void *const volatile *)ptr;
+}
+
+/* Strong, acquire-release compare-and-swap; on failure *expected receives the current value. */
+static inline bool vector_atomic_cas_ptr(void **ptr, void **expected, void *desired) {
+    void *seen = _InterlockedCompareExchangePointer((void *volatile *)ptr, desired, *expected);
+
+    if (seen == *expected) {
+        return true;
+    }
+
+    *expected = seen;
+
+    return false;
+}
+#else
+#define VECTOR_RELAXED __ATOMIC_RELAXED
+#define VECTOR_ACQUIRE __ATOMIC_ACQUIRE
+#define VECTOR_RELEASE __ATOMIC_RELEASE
+
+#define vector_atomic_load(ptr, order) __atomic_load_n((ptr), (order))
+#define vector_atomic_store(ptr, value, order) __atomic_store_n((ptr), (value), (order))
+#define vector_atomic_fetch_add(ptr, value, order) __atomic_fetch_add((ptr), (value), (order))
+#define vector_atomic_cas(ptr, expected, desired) \
+    __atomic_compare_exchange_n((ptr), (expected), (desired), true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#define vector_atomic_load_ptr(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define vector_atomic_cas_ptr(ptr, expected, desired) \
+    __atomic_compare_exchange_n((ptr), (expected), (desired), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#endif /* _MSC_VER */
+
+#endif /* VECTOR_INTERNAL_H_ */
@@ -0,0 +1,658 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define VECTOR_BUILD
+#include "vector_parallel.h"
+#include "vector_internal.h"
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <unistd.h>
+#define VECTOR_HAVE_PTHREADS
+#endif /* !_WIN32 */
+
+/* Chunks per thread when the grain is picked automatically, for load balancing. */
+#define VECTOR_CHUNKS_PER_THREAD 8
+
+static const VectorExecutor *vector_executor;
+
+#ifdef VECTOR_HAVE_PTHREADS
+/*
+ * Built-in pool: one job at a time, split into tasks that workers
+ * (and the submitting thread) claim with an atomic counter until
+ * none are left.
+ */
+typedef struct VectorThreadPool {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    pthread_mutex_t submit;
+    pthread_t *threads;
+    size_t n_threads;
+    unsigned long generation;
+    unsigned long start_generation;
+    bool running;
+    bool stop;
+    void (*task)(size_t idx, void *ctx);
+    void *ctx;
+    size_t n_tasks;
+    size_t next;
+    size_t active;
+} VectorThreadPool;
+
+static VectorThreadPool vector_thread_pool = {
+    PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_COND_INITIALIZER,
+    PTHREAD_COND_INITIALIZER,
+    PTHREAD_MUTEX_INITIALIZER,
+    NULL, 0, 0, 0, false, false, NULL, NULL, 0, 0, 0
+};
+
+static VECTOR_THREAD_LOCAL bool vector_in_worker;
+
+static void vector_thread_pool_drain(VectorThreadPool *pool) {
+    for (;;) {
+        const size_t idx = vector_atomic_fetch_add(&pool->next, 1, VECTOR_RELAXED);
+        if (idx >= pool->n_tasks) {
+            break;
+        }
+
+        pool->task(idx, pool->ctx);
+    }
+
+    return;
+}
+
+static void *vector_thread_pool_worker(void *arg) {
+    VectorThreadPool *pool = (VectorThreadPool *)arg;
+    unsigned long seen = 0;
+
+    vector_in_worker = true;
+
+    /* Jobs posted before this thread got the lock must still be picked up. */
+    pthread_mutex_lock(&pool->lock);
+    seen = pool->start_generation;
+
+    for (;;) {
+        while (pool->generation == seen && !pool->stop) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+
+        if (pool->stop) {
+            break;
+        }
+
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        vector_thread_pool_drain(pool);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->active == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+static size_t vector_default_threads(void) {
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return cpus > 1 ? (size_t)cpus - 1 : 0;
+}
+
+static bool vector_thread_pool_start(VectorThreadPool *pool, size_t threads) {
+    pthread_mutex_lock(&pool->lock);
+
+    if (pool->running) {
+        pthread_mutex_unlock(&pool->lock);
+        return true;
+    }
+
+    if (threads == 0) {
+        threads = vector_default_threads();
+    }
+
+    pool->threads = threads ? (pthread_t *)malloc(threads * sizeof(pthread_t)) : NULL;
+    if (threads && NULL == pool->threads) {
+        pthread_mutex_unlock(&pool->lock);
+        return false;
+    }
+
+    pool->stop = false;
+    pool->start_generation = pool->generation;
+    pool->n_threads = 0;
+    while (pool->n_threads < threads) {
+        if (pthread_create(&pool->threads[pool->n_threads], NULL, vector_thread_pool_worker, pool) != 0) {
+            break;
+        }
+        ++pool->n_threads;
+    }
+
+    pool->running = true;
+    pthread_mutex_unlock(&pool->lock);
+
+    return true;
+}
+
+static void vector_thread_pool_run(VectorThreadPool *pool, const size_t n_tasks, void (*task)(size_t idx, void *ctx), void *ctx) {
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->ctx = ctx;
+    pool->n_tasks = n_tasks;
+    pool->next = 0;
+    pool->active = pool->n_threads;
+    ++pool->generation;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    vector_in_worker = true;
+    vector_thread_pool_drain(pool);
+    vector_in_worker = false;
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->active > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return;
+}
+
+/* Background thread draining vectors queued by vector_destroy_async. */
+typedef struct VectorReaper {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t idle;
+    pthread_t thread;
+    bool running;
+    bool stop;
+    Vector *pending;
+    size_t in_flight;
+} VectorReaper;
+
+static VectorReaper vector_reaper = {
+    PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_COND_INITIALIZER,
+    PTHREAD_COND_INITIALIZER,
+    0, false, false, NULL, 0
+};
+
+static void *vector_reaper_main(void *arg) {
+    VectorReaper *reaper = (VectorReaper *)arg;
+    Vector *vec = NULL;
+
+    pthread_mutex_lock(&reaper->lock);
+
+    for (;;) {
+        while (vector_is_empty(reaper->pending) && !reaper->stop) {
+            pthread_cond_wait(&reaper->wake, &reaper->lock);
+        }
+
+        if (vector_is_empty(reaper->pending)) {
+            break;
+        }
+
+        vector_pop_back_into(reaper->pending, &vec);
+
+        ++reaper->in_flight;
+        pthread_mutex_unlock(&reaper->lock);
+
+        vector_destroy(vec);
+
+        pthread_mutex_lock(&reaper->lock);
+        if (--reaper->in_flight == 0 && vector_is_empty(reaper->pending)) {
+            pthread_cond_broadcast(&reaper->idle);
+        }
+    }
+
+    pthread_mutex_unlock(&reaper->lock);
+
+    return NULL;
+}
+
+static bool vector_reaper_start(VectorReaper *reaper) {
+    if (reaper->running) {
+        return true;
+    }
+
+    reaper->pending = vector_create(0, sizeof(Vector *), NULL);
+    if (NULL == reaper->pending) {
+        return false;
+    }
+
+    reaper->stop = false;
+    if (pthread_create(&reaper->thread, NULL, vector_reaper_main, reaper) != 0) {
+        vector_destroy(reaper->pending);
+        reaper->pending = NULL;
+        return false;
+    }
+
+    reaper->running = true;
+
+    return true;
+}
+
+static void vector_reaper_stop(VectorReaper *reaper) {
+    pthread_mutex_lock(&reaper->lock);
+    if (!reaper->running) {
+        pthread_mutex_unlock(&reaper->lock);
+        return;
+    }
+    reaper->stop = true;
+    pthread_cond_broadcast(&reaper->wake);
+    pthread_mutex_unlock(&reaper->lock);
+
+    pthread_join(reaper->thread, NULL);
+
+    pthread_mutex_lock(&reaper->lock);
+    vector_destroy(reaper->pending);
+    reaper->pending = NULL;
+    reaper->running = false;
+    pthread_cond_broadcast(&reaper->idle);
+    pthread_mutex_unlock(&reaper->lock);
+
+    return;
+}
+#endif /* VECTOR_HAVE_PTHREADS */
+
+bool vector_parallel_init(const size_t threads) {
+#ifdef VECTOR_HAVE_PTHREADS
+    return vector_thread_pool_start(&vector_thread_pool, threads);
+#else
+    (void)threads;
+    return false;
+#endif /* VECTOR_HAVE_PTHREADS */
+}
+
+void vector_parallel_shutdown(void) {
+#ifdef VECTOR_HAVE_PTHREADS
+    VectorThreadPool *pool = &vector_thread_pool;
+
+    vector_reaper_stop(&vector_reaper);
+
+    pthread_mutex_lock(&pool->lock);
+    if (!pool->running) {
+        pthread_mutex_unlock(&pool->lock);
+        return;
+    }
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->n_threads; ++i) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    free(pool->threads);
+    pool->threads = NULL;
+    pool->n_threads = 0;
+    pool->running = false;
+    pthread_mutex_unlock(&pool->lock);
+#endif /* VECTOR_HAVE_PTHREADS */
+
+    return;
+}
+
+void vector_parallel_set_executor(const VectorExecutor *executor) {
+    assert(executor == NULL || executor->run);
+
+    vector_executor = executor;
+
+    return;
+}
+
+static size_t vector_parallel_threads(void) {
+    if (vector_executor) {
+        return 0;
+    }
+
+#ifdef VECTOR_HAVE_PTHREADS
+    vector_thread_pool_start(&vector_thread_pool, 0);
+    return vector_thread_pool.n_threads;
+#else
+    return 0;
+#endif /* VECTOR_HAVE_PTHREADS */
+}
+
+void vector_parallel_run(const size_t n_tasks, void (*task)(size_t idx, void *ctx), void *ctx) {
+    assert(task);
+
+    const VectorExecutor *executor = vector_executor;
+    if (executor && n_tasks > 1) {
+        executor->run(executor->ctx, n_tasks, task, ctx);
+        return;
+    }
+
+#ifdef VECTOR_HAVE_PTHREADS
+    VectorThreadPool *pool = &vector_thread_pool;
+    if (n_tasks > 1 && !vector_in_worker && vector_thread_pool_start(pool, 0) && pool->n_threads > 0 &&
+        pthread_mutex_trylock(&pool->submit) == 0) {
+        vector_thread_pool_run(pool, n_tasks, task, ctx);
+        pthread_mutex_unlock(&pool->submit);
+        return;
+    }
+#endif /* VECTOR_HAVE_PTHREADS */
+
+    for (size_t i = 0; i < n_tasks; ++i) {
+        task(i, ctx);
+    }
+
+    return;
+}
+
+/* Round the grain up to whole cache lines worth of elements. */
+static size_t vector_parallel_grain(const Vector *vec, size_t grain) {
+    const size_t per_line = vec->elem_size >= VECTOR_CACHE_LINE ? 1 : VECTOR_CACHE_LINE / vec->elem_size;
+
+    if (grain == 0) {
+        const size_t threads = vector_parallel_threads() + 1;
+        grain = vec->elem_count / (threads * VECTOR_CHUNKS_PER_THREAD);
+    }
+
+    if (grain < per_line) {
+        grain = per_line;
+    }
+
+    return (grain + per_line - 1) / per_line * per_line;
+}
+
+typedef struct VectorForJob {
+    Vector *vec;
+    size_t grain;
+    void (*fn)(void *elem, size_t idx, void *ctx);
+    void *ctx;
+} VectorForJob;
+
+static void vector_parallel_for_task(const size_t chunk, void *arg) {
+    const VectorForJob *job = (const VectorForJob *)arg;
+    const size_t first = chunk * job->grain;
+    const size_t last = first + job->grain < job->vec->elem_count ? first + job->grain : job->vec->elem_count;
+    char *elem = (char *)job->vec->value + first * job->vec->elem_size;
+
+    for (size_t idx = first; idx < last; ++idx, elem += job->vec->elem_size) {
+        job->fn(elem, idx, job->ctx);
+    }
+
+    return;
+}
+
+void vector_parallel_for(Vector *vec, const size_t grain, void (*fn)(void *elem, size_t idx, void *ctx), void *ctx) {
+    assert(vec && fn);
+
+    if (vec->elem_count == 0 || NULL == vector_data_mut(vec)) {
+        return;
+    }
+
+    VectorForJob job;
+    job.vec = vec;
+    job.grain = vector_parallel_grain(vec, grain);
+    job.fn = fn;
+    job.ctx = ctx;
+
+    vector_parallel_run((vec->elem_count + job.grain - 1) / job.grain, vector_parallel_for_task, &job);
+
+    return;
+}
+
+typedef struct VectorReduceJob {
+    const Vector *vec;
+    size_t grain;
+    char *partials;
+    size_t stride;
+    void (*accumulate)(void *acc, const void *elem, size_t idx, void *ctx);
+    void *ctx;
+} VectorReduceJob;
+
+static void vector_parallel_reduce_task(const size_t chunk, void *arg) {
+    const VectorReduceJob *job = (const VectorReduceJob *)arg;
+    const size_t first = chunk * job->grain;
+    const size_t last = first + job->grain < job->vec->elem_count ? first + job->grain : job->vec->elem_count;
+    const char *elem = (const char *)job->vec->value + first * job->vec->elem_size;
+    void *acc = job->partials + chunk * job->stride;
+
+    for (size_t idx = first; idx < last; ++idx, elem += job->vec->elem_size) {
+        job->accumulate(acc, elem, idx, job->ctx);
+    }
+
+    return;
+}
+
+bool vector_parallel_reduce(const Vector *vec,
+                            const size_t grain,
+                            void *result,
+                            const size_t result_size,
+                            void (*accumulate)(void *acc, const void *elem, size_t idx, void *ctx),
+                            void (*combine)(void *acc, const void *other, void *ctx),
+                            void *ctx) {
+    assert(vec && result && result_size > 0 && accumulate && combine);
+
+    VectorReduceJob job;
+    job.vec = vec;
+    job.grain = vector_parallel_grain(vec, grain);
+    job.accumulate = accumulate;
+    job.ctx = ctx;
+
+    const size_t n_chunks = (vec->elem_count + job.grain - 1) / job.grain;
+    if (n_chunks == 0) {
+        return true;
+    }
+
+    /* Pad each partial to a cache line so accumulators don't false-share. */
+    job.stride = (result_size + VECTOR_CACHE_LINE - 1) / VECTOR_CACHE_LINE * VECTOR_CACHE_LINE;
+    if (n_chunks > SIZE_MAX / job.stride) {
+        return false;
+    }
+
+    job.partials = (char *)malloc(n_chunks * job.stride);
+    if (NULL == job.partials) {
+        return false;
+    }
+
+    for (size_t chunk = 0; chunk < n_chunks; ++chunk) {
+        memcpy(job.partials + chunk * job.stride, result, result_size);
+    }
+
+    vector_parallel_run(n_chunks, vector_parallel_reduce_task, &job);
+
+    for (size_t chunk = 0; chunk < n_chunks; ++chunk) {
+        combine(result, job.partials + chunk * job.stride, ctx);
+    }
+
+    free(job.partials);
+
+    return true;
+}
+
+typedef struct VectorClearJob {
+    Vector *vec;
+    size_t grain;
+} VectorClearJob;
+
+static void vector_parallel_clear_task(const size_t chunk, void *arg) {
+    const VectorClearJob *job = (const VectorClearJob *)arg;
+    const Vector *vec = job->vec;
+    const size_t first = chunk * job->grain;
+    const size_t last = first + job->grain < vec->elem_count ? first + job->grain : vec->elem_count;
+    char *ptr = (char *)vec->value + first * vec->elem_size;
+
+    if (vec->destroy_range) {
+        vec->destroy_range(ptr, last - first);
+        return;
+    }
+
+    for (size_t idx = first; idx < last; ++idx, ptr += vec->elem_size) {
+        vec->destructor(ptr);
+    }
+
+    return;
+}
+
+void vector_parallel_clear(Vector *vec, const size_t grain) {
+    assert(vec);
+
+    /* vector_clear knows which sharer of copy-on-write storage owns the elements. */
+    if (vec->shared) {
+        vector_clear(vec);
+        return;
+    }
+
+    if (vec->destroy_range || vec->destructor) {
+        VectorClearJob job;
+        job.vec = vec;
+        job.grain = vector_parallel_grain(vec, grain);
+
+        vector_parallel_run((vec->elem_count + job.grain - 1) / job.grain, vector_parallel_clear_task, &job);
+    }
+
+    vector_reset(vec);
+
+    return;
+}
+
+void vector_parallel_destroy(Vector *vec, const size_t grain) {
+    assert(vec);
+
+    vector_parallel_clear(vec, grain);
+    vector_destroy(vec);
+
+    return;
+}
+
+typedef struct VectorCloneJob {
+    const Vector *vec;
+    Vector *clone;
+    size_t grain;
+    bool *copied;
+    bool (*copy_range)(void *dst, const void *src, size_t count, void *ctx);
+    void *ctx;
+} VectorCloneJob;
+
+static void vector_parallel_clone_task(const size_t chunk, void *arg) {
+    const VectorCloneJob *job = (const VectorCloneJob *)arg;
+    const size_t first = chunk * job->grain;
+    const size_t last = first + job->grain < job->vec->elem_count ? first + job->grain : job->vec->elem_count;
+    const size_t offset = first * job->vec->elem_size;
+
+    job->copied[chunk] = job->copy_range((char *)job->clone->value + offset,
+                                         (const char *)job->vec->value + offset,
+                                         last - first,
+                                         job->ctx);
+
+    return;
+}
+
+Vector *vector_parallel_clone_deep(const Vector *vec,
+                                   const size_t grain,
+                                   bool (*copy_range)(void *dst, const void *src, size_t count, void *ctx),
+                                   void *ctx) {
+    assert(vec && copy_range);
+
+    Vector *clone = vector_clone_empty(vec, vec->elem_count);
+    if (NULL == clone || vec->elem_count == 0) {
+        return clone;
+    }
+
+    VectorCloneJob job;
+    job.vec = vec;
+    job.clone = clone;
+    job.grain = vector_parallel_grain(vec, grain);
+    job.copy_range = copy_range;
+    job.ctx = ctx;
+
+    const size_t n_chunks = (vec->elem_count + job.grain - 1) / job.grain;
+
+    job.copied = (bool *)malloc(n_chunks * sizeof(bool));
+    if (NULL == job.copied) {
+        vector_destroy(clone);
+        return NULL;
+    }
+
+    vector_parallel_run(n_chunks, vector_parallel_clone_task, &job);
+
+    clone->elem_count = vec->elem_count;
+
+    bool ok = true;
+    for (size_t chunk = 0; chunk < n_chunks; ++chunk) {
+        ok = ok && job.copied[chunk];
+    }
+
+    if (!ok) {
+        /* Destroy only the chunks that were constructed. */
+        for (size_t chunk = 0; chunk < n_chunks; ++chunk) {
+            if (job.copied[chunk] && (clone->destroy_range || clone->destructor)) {
+                VectorClearJob clear;
+                clear.vec = clone;
+                clear.grain = job.grain;
+                vector_parallel_clear_task(chunk, &clear);
+            }
+        }
+
+        vector_reset(clone);
+        vector_destroy(clone);
+        clone = NULL;
+    }
+
+    free(job.copied);
+
+    return clone;
+}
+
+static bool vector_parallel_copy_range(void *dst, const void *src, const size_t count, void *ctx) {
+    memcpy(dst, src, count * *(const size_t *)ctx);
+
+    return true;
+}
+
+Vector *vector_parallel_clone(const Vector *vec, const size_t grain) {
+    assert(vec);
+
+    size_t elem_size = vec->elem_size;
+
+    return vector_parallel_clone_deep(vec, grain, vector_parallel_copy_range, &elem_size);
+}
+
+void vector_destroy_async(Vector *vec) {
+    assert(vec);
+
+#ifdef VECTOR_HAVE_PTHREADS
+    VectorReaper *reaper = &vector_reaper;
+
+    pthread_mutex_lock(&reaper->lock);
+    if (vector_reaper_start(reaper) && vector_push_back(reaper->pending, &vec)) {
+        pthread_cond_signal(&reaper->wake);
+        pthread_mutex_unlock(&reaper->lock);
+        return;
+    }
+    pthread_mutex_unlock(&reaper->lock);
+#endif /* VECTOR_HAVE_PTHREADS */
+
+    vector_destroy(vec);
+
+    return;
+}
+
+void vector_destroy_async_wait(void) {
+#ifdef VECTOR_HAVE_PTHREADS
+    VectorReaper *reaper = &vector_reaper;
+
+    pthread_mutex_lock(&reaper->lock);
+    while (reaper->running && (reaper->in_flight > 0 || !vector_is_empty(reaper->pending))) {
+        pthread_cond_wait(&reaper->idle, &reaper->lock);
+    }
+    pthread_mutex_unlock(&reaper->lock);
+#endif /* VECTOR_HAVE_PTHREADS */
+
+    return;
+}
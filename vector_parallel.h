@@ -0,0 +1,210 @@
+/**
+ * @file vector_parallel.h
+ * @author itsjustgalileo
+ * @version 1.2
+ * @brief Parallel traversal of vectors.
+ */
+#ifndef VECTOR_PARALLEL_H_
+#define VECTOR_PARALLEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "vector.h"
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /**
+     * @brief Pluggable executor used to run parallel work.
+     *
+     * run must call task(i, task_ctx) exactly once for every i in
+     * [0, n_tasks), possibly concurrently, and return only once all
+     * calls have completed.
+     */
+    typedef struct VectorExecutor {
+        /** Run n_tasks tasks and wait for them. Required. */
+        void (*run)(void *ctx, size_t n_tasks, void (*task)(size_t idx, void *task_ctx), void *task_ctx);
+        /** User context passed to run. */
+        void *ctx;
+    } VectorExecutor;
+
+    /**
+     * @brief Start the built-in thread pool with a given number of workers.
+     *
+     * Optional: the pool otherwise starts on first use with one
+     * worker per online CPU minus one (the calling thread also takes
+     * part). Has no effect if the pool is already running.
+     *
+     * On platforms without POSIX threads, parallel work runs serially
+     * on the calling thread unless an executor is installed.
+     *
+     * @param threads Number of worker threads (0 for the default).
+     *
+     * @return true if the pool is running.
+     */
+    extern bool vector_parallel_init(size_t threads);
+
+    /**
+     * @brief Stop and join the built-in thread pool.
+     *
+     * Waits for pending vector_destroy_async work and stops the
+     * reaper thread as well. Must not be called while parallel work
+     * is in flight.
+     */
+    extern void vector_parallel_shutdown(void);
+
+    /**
+     * @brief Route parallel work to a user-supplied executor.
+     *
+     * The executor is referenced, not copied.
+     *
+     * @param executor Executor to use, or NULL for the built-in pool.
+     */
+    extern void vector_parallel_set_executor(const VectorExecutor *executor);
+
+    /**
+     * @brief Run task(i, ctx) for every i in [0, n_tasks) in parallel.
+     *
+     * Uses the installed executor or the built-in pool. Calls made
+     * from inside a pool task, or while the pool is busy with another
+     * caller's work, run serially on the calling thread.
+     *
+     * @param n_tasks Number of tasks.
+     * @param task    Task body.
+     * @param ctx     User context passed to task.
+     */
+    extern void vector_parallel_run(size_t n_tasks, void (*task)(size_t idx, void *ctx), void *ctx);
+
+    /**
+     * @brief Apply fn to every element of a vector in parallel.
+     *
+     * Elements are split into chunks of grain elements, rounded up to
+     * whole cache lines so that chunks written by different threads
+     * never share a line. fn may modify the element it is given but
+     * must not modify the vector itself. Shared copy-on-write storage
+     * is copied first; if that fails, fn is not called.
+     *
+     * @param vec   Vector to traverse.
+     * @param grain Elements per chunk, or 0 to pick one automatically.
+     * @param fn    Callback receiving each element and its index.
+     * @param ctx   User context passed to fn.
+     */
+    extern void vector_parallel_for(Vector *vec,
+                                    size_t grain,
+                                    void (*fn)(void *elem, size_t idx, void *ctx),
+                                    void *ctx);
+
+    /**
+     * @brief Reduce the elements of a vector in parallel.
+     *
+     * result holds the identity value on entry and the reduction on
+     * return. Each chunk starts from a copy of the identity and folds
+     * its elements in with accumulate; the partial results are then
+     * merged in chunk order with combine, so the result is
+     * deterministic for a given grain.
+     *
+     * @param vec         Vector to reduce.
+     * @param grain       Elements per chunk, or 0 to pick one automatically.
+     * @param result      Identity on entry, result on return.
+     * @param result_size Size in bytes of result.
+     * @param accumulate  Fold one element into an accumulator.
+     * @param combine     Merge the accumulator other into acc.
+     * @param ctx         User context passed to both callbacks.
+     *
+     * @return true on success, false if partial results could not be allocated.
+     */
+    extern bool vector_parallel_reduce(const Vector *vec,
+                                       size_t grain,
+                                       void *result,
+                                       size_t result_size,
+                                       void (*accumulate)(void *acc, const void *elem, size_t idx, void *ctx),
+                                       void (*combine)(void *acc, const void *other, void *ctx),
+                                       void *ctx);
+
+    /**
+     * @brief Destroy the elements of a vector in parallel, keeping its storage.
+     *
+     * Like vector_clear, but runs the batch or per-element destructor
+     * over chunks of grain elements concurrently. Destructors must be
+     * safe to call from several threads at once.
+     *
+     * @param vec   Vector to clear.
+     * @param grain Elements per chunk, or 0 to pick one automatically.
+     */
+    extern void vector_parallel_clear(Vector *vec, size_t grain);
+
+    /**
+     * @brief Destroy a vector, running its destructors in parallel.
+     *
+     * Same as vector_parallel_clear followed by vector_destroy.
+     *
+     * @param vec   Vector to destroy.
+     * @param grain Elements per chunk, or 0 to pick one automatically.
+     */
+    extern void vector_parallel_destroy(Vector *vec, size_t grain);
+
+    /**
+     * @brief Create a shallow clone of a vector, copying chunks in parallel.
+     *
+     * Same result as vector_clone. Splitting the copy lets several
+     * cores share the memory bandwidth, which pays off from a few
+     * megabytes upwards.
+     *
+     * @param vec   Vector to clone.
+     * @param grain Elements per chunk, or 0 to pick one automatically.
+     *
+     * @return New vector with copied contents, or NULL on failure.
+     */
+    extern Vector *vector_parallel_clone(const Vector *vec, size_t grain);
+
+    /**
+     * @brief Create a deep clone of a vector, copying chunks in parallel.
+     *
+     * Parallel form of vector_clone_deep_range: copy_range is called
+     * concurrently on chunks of grain elements, each copied into
+     * place in storage allocated once at the exact size, so it must
+     * be safe to call from several threads at once. A failing call
+     * must leave no constructed elements in its chunk; the chunks
+     * that did succeed are then destroyed.
+     *
+     * @param vec        Vector to clone.
+     * @param grain      Elements per chunk, or 0 to pick one automatically.
+     * @param copy_range Construct count elements at dst from src; return false on failure.
+     * @param ctx        User context passed to copy_range.
+     *
+     * @return New vector with copied contents, or NULL on failure.
+     */
+    extern Vector *vector_parallel_clone_deep(const Vector *vec,
+                                              size_t grain,
+                                              bool (*copy_range)(void *dst, const void *src, size_t count, void *ctx),
+                                              void *ctx);
+
+    /**
+     * @brief Hand a vector to a background thread for destruction.
+     *
+     * Returns immediately; the vector is destroyed later with
+     * vector_destroy on a reaper thread started on first use, so its
+     * destructors and allocator must be callable from another
+     * thread. The vector must not be touched after this call. Falls
+     * back to destroying it on the calling thread if no reaper can be
+     * started.
+     *
+     * @param vec Heap vector to destroy (not one set up with vector_init).
+     */
+    extern void vector_destroy_async(Vector *vec);
+
+    /**
+     * @brief Wait until every vector passed to vector_destroy_async is destroyed.
+     */
+    extern void vector_destroy_async_wait(void);
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VECTOR_PARALLEL_H_ */
@@ -0,0 +1,476 @@
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define VECTOR_BUILD
+#include "vector.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VECTOR_HAVE_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+#define VECTOR_HAVE_AVX2
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define VECTOR_HAVE_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(VECTOR_HAVE_AVX2) && (defined(__GNUC__) || defined(__clang__))
+#define VECTOR_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define VECTOR_TARGET_AVX2
+#endif
+
+/* Sentinel returned by the kernels when nothing matches. */
+#define VECTOR_NPOS SIZE_MAX
+
+static unsigned vector_ctz(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctz(mask);
+#elif defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward(&idx, mask);
+    return (unsigned)idx;
+#else
+    unsigned idx = 0;
+    while (!(mask & 1u)) {
+        mask >>= 1;
+        ++idx;
+    }
+    return idx;
+#endif
+}
+
+static unsigned vector_popcount(uint32_t mask) {
+    mask = mask - ((mask >> 1) & 0x55555555u);
+    mask = (mask & 0x33333333u) + ((mask >> 2) & 0x33333333u);
+    mask = (mask + (mask >> 4)) & 0x0f0f0f0fu;
+
+    return (unsigned)((mask * 0x01010101u) >> 24);
+}
+
+static uint64_t vector_load_scalar(const void *ptr, const size_t width) {
+    uint8_t u8;
+    uint16_t u16;
+    uint32_t u32;
+    uint64_t u64;
+
+    switch (width) {
+    case 1:
+        memcpy(&u8, ptr, 1);
+        return u8;
+    case 2:
+        memcpy(&u16, ptr, 2);
+        return u16;
+    case 4:
+        memcpy(&u32, ptr, 4);
+        return u32;
+    default:
+        memcpy(&u64, ptr, 8);
+        return u64;
+    }
+}
+
+/*
+ * Portable kernels. Widths 1, 2, 4 and 8 compare whole words; other
+ * sizes fall back to memcmp.
+ */
+
+static size_t vector_find_scalar(const char *base, const size_t count, const size_t width, const void *elem) {
+    if (width == 1) {
+        const char *hit = (const char *)memchr(base, *(const unsigned char *)elem, count);
+        return hit ? (size_t)(hit - base) : VECTOR_NPOS;
+    }
+
+    if (width == 2 || width == 4 || width == 8) {
+        const uint64_t needle = vector_load_scalar(elem, width);
+        for (size_t i = 0; i < count; ++i) {
+            if (vector_load_scalar(base + i * width, width) == needle) {
+                return i;
+            }
+        }
+        return VECTOR_NPOS;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (memcmp(base + i * width, elem, width) == 0) {
+            return i;
+        }
+    }
+
+    return VECTOR_NPOS;
+}
+
+static size_t vector_count_scalar(const char *base, const size_t count, const size_t width, const void *elem) {
+    size_t found = 0;
+
+    if (width == 1 || width == 2 || width == 4 || width == 8) {
+        const uint64_t needle = vector_load_scalar(elem, width);
+        for (size_t i = 0; i < count; ++i) {
+            found += vector_load_scalar(base + i * width, width) == needle;
+        }
+        return found;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        found += memcmp(base + i * width, elem, width) == 0;
+    }
+
+    return found;
+}
+
+/*
+ * SIMD kernels operate on widths 1, 2, 4 and 8. Each processes full
+ * vectors and leaves the remaining tail to the caller, returning the
+ * number of elements consumed through *done.
+ */
+
+#ifdef VECTOR_HAVE_SSE2
+static __m128i vector_sse2_cmpeq(const __m128i a, const __m128i b, const size_t width) {
+    switch (width) {
+    case 1:
+        return _mm_cmpeq_epi8(a, b);
+    case 2:
+        return _mm_cmpeq_epi16(a, b);
+    case 4:
+        return _mm_cmpeq_epi32(a, b);
+    default: {
+        /* No 64-bit compare in SSE2: both 32-bit halves must match. */
+        const __m128i eq = _mm_cmpeq_epi32(a, b);
+        return _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+    }
+    }
+}
+
+static __m128i vector_sse2_splat(const void *elem, const size_t width) {
+    const uint64_t bits = vector_load_scalar(elem, width);
+
+    switch (width) {
+    case 1:
+        return _mm_set1_epi8((char)bits);
+    case 2:
+        return _mm_set1_epi16((short)bits);
+    case 4:
+        return _mm_set1_epi32((int)bits);
+    default:
+        return _mm_set_epi32((int)(bits >> 32), (int)bits, (int)(bits >> 32), (int)bits);
+    }
+}
+
+static size_t vector_find_sse2(const char *base, const size_t count, const size_t width, const void *elem, size_t *done) {
+    const __m128i needle = vector_sse2_splat(elem, width);
+    const size_t step = 16 / width;
+    size_t i = 0;
+
+    for (; i + step <= count; i += step) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i *)(const void *)(base + i * width));
+        const uint32_t mask = (uint32_t)_mm_movemask_epi8(vector_sse2_cmpeq(chunk, needle, width));
+        if (mask) {
+            *done = i;
+            return i + vector_ctz(mask) / width;
+        }
+    }
+
+    *done = i;
+
+    return VECTOR_NPOS;
+}
+
+static size_t vector_count_sse2(const char *base, const size_t count, const size_t width, const void *elem, size_t *done) {
+    const __m128i needle = vector_sse2_splat(elem, width);
+    const size_t step = 16 / width;
+    size_t found_bytes = 0;
+    size_t i = 0;
+
+    for (; i + step <= count; i += step) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i *)(const void *)(base + i * width));
+        found_bytes += vector_popcount((uint32_t)_mm_movemask_epi8(vector_sse2_cmpeq(chunk, needle, width)));
+    }
+
+    *done = i;
+
+    return found_bytes / width;
+}
+#endif /* VECTOR_HAVE_SSE2 */
+
+#ifdef VECTOR_HAVE_AVX2
+VECTOR_TARGET_AVX2
+static __m256i vector_avx2_cmpeq(const __m256i a, const __m256i b, const size_t width) {
+    switch (width) {
+    case 1:
+        return _mm256_cmpeq_epi8(a, b);
+    case 2:
+        return _mm256_cmpeq_epi16(a, b);
+    case 4:
+        return _mm256_cmpeq_epi32(a, b);
+    default:
+        return _mm256_cmpeq_epi64(a, b);
+    }
+}
+
+VECTOR_TARGET_AVX2
+static __m256i vector_avx2_splat(const void *elem, const size_t width) {
+    const uint64_t bits = vector_load_scalar(elem, width);
+
+    switch (width) {
+    case 1:
+        return _mm256_set1_epi8((char)bits);
+    case 2:
+        return _mm256_set1_epi16((short)bits);
+    case 4:
+        return _mm256_set1_epi32((int)bits);
+    default:
+        return _mm256_set1_epi64x((long long)bits);
+    }
+}
+
+VECTOR_TARGET_AVX2
+static size_t vector_find_avx2(const char *base, const size_t count, const size_t width, const void *elem, size_t *done) {
+    const __m256i needle = vector_avx2_splat(elem, width);
+    const size_t step = 32 / width;
+    size_t i = 0;
+
+    for (; i + step <= count; i += step) {
+        const __m256i chunk = _mm256_loadu_si256((const __m256i *)(const void *)(base + i * width));
+        const uint32_t mask = (uint32_t)_mm256_movemask_epi8(vector_avx2_cmpeq(chunk, needle, width));
+        if (mask) {
+            *done = i;
+            return i + vector_ctz(mask) / width;
+        }
+    }
+
+    *done = i;
+
+    return VECTOR_NPOS;
+}
+
+VECTOR_TARGET_AVX2
+static size_t vector_count_avx2(const char *base, const size_t count, const size_t width, const void *elem, size_t *done) {
+    const __m256i needle = vector_avx2_splat(elem, width);
+    const size_t step = 32 / width;
+    size_t found_bytes = 0;
+    size_t i = 0;
+
+    for (; i + step <= count; i += step) {
+        const __m256i chunk = _mm256_loadu_si256((const __m256i *)(const void *)(base + i * width));
+        found_bytes += vector_popcount((uint32_t)_mm256_movemask_epi8(vector_avx2_cmpeq(chunk, needle, width)));
+    }
+
+    *done = i;
+
+    return found_bytes / width;
+}
+
+static bool vector_cpu_has_avx2(void) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif /* VECTOR_HAVE_AVX2 */
+
+#ifdef VECTOR_HAVE_NEON
+static uint8x16_t vector_neon_cmpeq(const uint8x16_t a, const uint8x16_t b, const size_t width) {
+    switch (width) {
+    case 1:
+        return vceqq_u8(a, b);
+    case 2:
+        return vreinterpretq_u8_u16(vceqq_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+    case 4:
+        return vreinterpretq_u8_u32(vceqq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)));
+    default:
+        return vreinterpretq_u8_u64(vceqq_u64(vreinterpretq_u64_u8(a), vreinterpretq_u64_u8(b)));
+    }
+}
+
+static uint8x16_t vector_neon_splat(const void *elem, const size_t width) {
+    uint8_t bytes[16];
+
+    for (size_t i = 0; i < 16; i += width) {
+        memcpy(bytes + i, elem, width);
+    }
+
+    return vld1q_u8(bytes);
+}
+
+static size_t vector_find_neon(const char *base, const size_t count, const size_t width, const void *elem, size_t *done) {
+    const uint8x16_t needle = vector_neon_splat(elem, width);
+    const size_t step = 16 / width;
+    size_t i = 0;
+
+    for (; i + step <= count; i += step) {
+        const uint8x16_t eq = vector_neon_cmpeq(vld1q_u8((const uint8_t *)base + i * width), needle, width);
+        if (vmaxvq_u8(eq)) {
+            *done = i;
+            return i + vector_find_scalar(base + i * width, step, width, elem);
+        }
+    }
+
+    *done = i;
+
+    return VECTOR_NPOS;
+}
+
+static size_t vector_count_neon(const char *base, const size_t count, const size_t width, const void *elem, size_t *done) {
+    const uint8x16_t needle = vector_neon_splat(elem, width);
+    const size_t step = 16 / width;
+    size_t found_bytes = 0;
+    size_t i = 0;
+
+    for (; i + step <= count; i += step) {
+        const uint8x16_t eq = vector_neon_cmpeq(vld1q_u8((const uint8_t *)base + i * width), needle, width);
+        found_bytes += vaddvq_u8(vshrq_n_u8(eq, 7));
+    }
+
+    *done = i;
+
+    return found_bytes / width;
+}
+#endif /* VECTOR_HAVE_NEON */
+
+typedef size_t (*vector_kernel)(const char *base, size_t count, size_t width, const void *elem, size_t *done);
+
+typedef struct VectorKernels {
+    vector_kernel find;
+    vector_kernel count;
+} VectorKernels;
+
+/* Resolved once; concurrent first calls race benignly to the same result. */
+static const VectorKernels *vector_kernels(void) {
+    static const VectorKernels *selected = NULL;
+
+    if (NULL == selected) {
+#ifdef VECTOR_HAVE_AVX2
+        static const VectorKernels avx2 = { vector_find_avx2, vector_count_avx2 };
+#endif
+#ifdef VECTOR_HAVE_SSE2
+        static const VectorKernels sse2 = { vector_find_sse2, vector_count_sse2 };
+#endif
+#ifdef VECTOR_HAVE_NEON
+        static const VectorKernels neon = { vector_find_neon, vector_count_neon };
+#endif
+        static const VectorKernels none = { NULL, NULL };
+        const VectorKernels *kernels = &none;
+
+#if defined(VECTOR_HAVE_SSE2)
+        kernels = &sse2;
+#elif defined(VECTOR_HAVE_NEON)
+        kernels = &neon;
+#endif
+#ifdef VECTOR_HAVE_AVX2
+        if (vector_cpu_has_avx2()) {
+            kernels = &avx2;
+        }
+#endif
+
+        selected = kernels;
+    }
+
+    return selected;
+}
+
+static bool vector_simd_width(const size_t width) {
+    return width == 1 || width == 2 || width == 4 || width == 8;
+}
+
+size_t vector_find(const Vector *vec, const void *elem) {
+    assert(vec && elem);
+
+    const char *base = (const char *)vec->value;
+    const size_t width = vec->elem_size;
+    const VectorKernels *kernels = vector_kernels();
+    size_t done = 0;
+
+    if (kernels->find && width != 1 && vector_simd_width(width)) {
+        const size_t hit = kernels->find(base, vec->elem_count, width, elem, &done);
+        if (hit != VECTOR_NPOS) {
+            return hit;
+        }
+    }
+
+    const size_t hit = vector_find_scalar(base + done * width, vec->elem_count - done, width, elem);
+
+    return hit == VECTOR_NPOS ? vec->elem_count : done + hit;
+}
+
+bool vector_contains(const Vector *vec, const void *elem) {
+    return vector_find(vec, elem) != vec->elem_count;
+}
+
+size_t vector_count(const Vector *vec, const void *elem) {
+    assert(vec && elem);
+
+    const char *base = (const char *)vec->value;
+    const size_t width = vec->elem_size;
+    const VectorKernels *kernels = vector_kernels();
+    size_t found = 0;
+    size_t done = 0;
+
+    if (kernels->count && vector_simd_width(width)) {
+        found = kernels->count(base, vec->elem_count, width, elem, &done);
+    }
+
+    return found + vector_count_scalar(base + done * width, vec->elem_count - done, width, elem);
+}
+
+void vector_fill(Vector *vec, const size_t first, const size_t count, const void *elem) {
+    assert(vec && elem && first <= vec->elem_count && count <= vec->elem_count - first);
+
+    if (count == 0) {
+        return;
+    }
+
+    char *base = (char *)vector_data_mut(vec);
+    if (NULL == base) {
+        return;
+    }
+
+    char *dst = base + first * vec->elem_size;
+    const size_t total = count * vec->elem_size;
+
+    if (vec->elem_size == 1) {
+        memset(dst, *(const unsigned char *)elem, count);
+        return;
+    }
+
+    /* Double the filled prefix each step so the bulk goes through memcpy. */
+    memcpy(dst, elem, vec->elem_size);
+    size_t filled = vec->elem_size;
+    while (filled < total) {
+        const size_t chunk = filled < total - filled ? filled : total - filled;
+        memcpy(dst + filled, dst, chunk);
+        filled += chunk;
+    }
+
+    return;
+}
+
+bool vector_equal(const Vector *a, const Vector *b) {
+    assert(a && b);
+
+    if (a->elem_size != b->elem_size || a->elem_count != b->elem_count) {
+        return false;
+    }
+
+    return a->value == b->value || memcmp(a->value, b->value, a->elem_count * a->elem_size) == 0;
+}